@@ -1,7 +1,20 @@
+# art dependencies
+target_include_directories(art PUBLIC ${CMAKE_BINARY_DIR}/source/application ${utilsDir})
 # menu_constants dependencies
 target_include_directories(menu_constants PRIVATE ${CMAKE_CURRENT_LIST_DIR} ${utilsDir})
-target_link_libraries(menu_constants PRIVATE start base PUBLIC menu)
+target_link_libraries(menu_constants PRIVATE art start base PUBLIC menu)
+# state dependencies
+target_include_directories(state PUBLIC ${utilsDir})
+target_link_libraries(state PRIVATE accounting base)
 # start dependencies
 target_include_directories(start PRIVATE ${CMAKE_CURRENT_LIST_DIR} PUBLIC ${utilsDir})
-target_link_libraries(start PRIVATE menu state ${ncursesLib} menu_constants sudoku PUBLIC base)
+target_link_libraries(start PRIVATE accounting art menu ${ncursesLib} menu_constants sudoku logging utf8 keys window_pool PUBLIC base state)
 
+# snapshot dependencies
+target_include_directories(snapshot PRIVATE ${CMAKE_CURRENT_LIST_DIR} PUBLIC ${utilsDir})
+target_link_libraries(snapshot PRIVATE accounting menu sudoku state PUBLIC base)
+# server dependencies
+if (CMAKE_SYSTEM_NAME STREQUAL "Linux")
+    target_include_directories(server PRIVATE ${CMAKE_CURRENT_LIST_DIR} PUBLIC ${utilsDir})
+    target_link_libraries(server PRIVATE accounting ${ncursesLib} start menu_constants snapshot logging recorder utf8 state base window_pool)
+endif ()
@@ -4,202 +4,20 @@
  *
  * \brief Declarations for menu instances used in the game
  *
- * Contains definitions of banners and choices for menus appearing in the game,
- * as well as the definitions of those menus.
+ * Contains definitions of choices for menus appearing in the game, as well as
+ * the definitions of those menus. Their banners are generated from the art in
+ * assets/art, see tools/banner.py.
  */
 
 #include <limits.h>
 #include <stddef.h>
 
+#include "art.h"
 #include "base.h"
 #include "menu.h"
 #include "menu_constants.h"
 #include "start.h"
 
-// clang-format off
-char const* const title[7] = {
-    " ___________  _______   _______   ___      ___       _______       __       ___      ___   _______ ",
-    "(\"     _   \")/\"     \"| /\"      \\ |\"  \\    /\"  |     /\" _   \"|     /\"\"\\     |\"  \\    /\"  | /\"     \"|",
-    " )__/  \\\\__/(: ______)|:        | \\   \\  //   |    (: ( \\___)    /    \\     \\   \\  //   |(: ______)",
-    "    \\\\_ /    \\/    |  |_____/   ) /\\\\  \\/.    |     \\/ \\        /' /\\  \\    /\\\\  \\/.    | \\/    |  ",
-    "    |.  |    // ___)_  //      / |: \\.        |     //  \\ ___  //  __'  \\  |: \\.        | // ___)_ \n",
-    "    \\:  |   (:      \"||:  __   \\ |.  \\    /:  |    (:   _(  _|/   /  \\\\  \\ |.  \\    /:  |(:      \"|",
-    "     \\__|    \\_______)|__|  \\___)|___|\\__/|___|     \\_______)(___/    \\___)|___|\\__/|___| \\_______)",
-};
-
-char const* const run[9] = {
-" (            )              \n",
-" )\\ )      ( /(               \n",
-"(()/(   (  )\\())              \n",
-" /(_))  )\\((_)\\              \n",
-"(_)) _ ((_)_((_) __    _   __\n",
-"| _ | | | | \\| | \\ \\  (_) | _|\n",
-"|   | |_| | .` |  > >  _  | |\n",
-"|_|_\\\\___/|_|\\_| /_/  (_) | | \n",
-"                          |__|\n",
-};
-
-char const* const questionmark[] = {
-"       ________",
-"   _jgN########Ngg_",
-" _N##N@@\"\"  \"\"9NN##Np_",
-"d###P            N####p",
-"\"^^\"              T####",
-"                  d###P",
-"               _g###@F",
-"            _gN##@P",
-"          gN###F\"",
-"         d###F",
-"        0###F",
-"        0###F",
-"        0###",
-"        \"NN@'",
-"",
-"         ___",
-"        q###r",
-"         \"\"",
-};
-
-const char* const well_art[] = {
-    "⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⣀⡀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀",
-    "⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⢀⣀⣠⣤⣤⣶⣶⠿⠿⠟⠛⢻⣧⡀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀",
-    "⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⣀⣀⣀⣤⣤⣶⣶⣾⡿⣟⢻⡏⡹⢿⡀⡶⡖⠀⠀⣀⣠⣿⣧⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀",
-    "⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⣀⣠⣤⣴⣶⡶⠿⠿⠛⡟⢻⠉⣿⣹⣇⣹⣸⠃⡟⢱⣏⣾⣷⠯⠗⠚⠫⣅⠀⠈⢿⣧⠀⠀⠀⠀⠀⠀⠀⠀⠀",
-    "⠀⠀⠀⠀⠀⠀⠀⢀⣀⣤⣴⠾⠟⠛⠝⠻⢻⠁⢹⣄⠁⠰⠀⠆⠀⢁⣟⣼⠯⡽⠶⠛⠋⠉⠀⠀⠀⠀⠀⠀⠘⣆⣠⢬⢿⣦⠀⠀⠀⠀⠀⠀⠀⠀",
-    "⠀⠀⠀⠀⠀⠀⢠⣾⠉⢧⡀⠀⠠⠂⠂⠀⠀⠀⠀⢘⣦⡴⠶⠒⡟⢹⠁⠀⠀⠀⠈⠀⢰⡀⢀⣀⣤⡤⠶⠒⠙⠉⢙⠈⠃⣿⣇⠀⠀⠀⠀⠀⠀⠀",
-    "⠀⠀⠀⠀⠀⣠⡿⠃⢀⠈⢳⡀⠀⠀⠠⠀⠂⠈⠁⠀⠀⠀⠀⠀⠀⣧⠀⠆⢀⣀⣤⠴⠚⠋⠉⢀⠀⠁⢄⠀⠀⠀⡞⢸⣠⣬⣿⣧⠀⠀⠀⠀⠀⠀",
-    "⠀⠀⠀⠀⣠⡿⠁⢠⡾⣦⠀⢳⡀⠁⠄⠰⠡⡄⠀⠀⠀⢐⣀⣄⠤⠾⠛⠋⠉⢣⡀⠀⠀⠀⡜⡜⠀⣀⣸⣶⠷⠚⠋⣯⡈⠐⢨⣿⣷⡀⠀⠀⠀⠀",
-    "⠀⠀⠀⢠⣿⠁⢀⣾⡇⣯⣷⡀⠻⡄⠀⠀⠀⠱⡤⠴⠚⠛⡏⠀⠀⠀⠀⠀⠀⠀⢳⡀⢀⣴⠿⢳⠛⡉⠀⠀⠀⡄⢰⠘⣇⠆⢸⣀⣻⣷⡀⠀⠀⠀",
-    "⠀⠀⢠⣿⠃⠀⣼⣿⢿⣿⠿⣷⡀⢹⡄⠀⠁⠀⠀⠀⠀⠀⠹⣄⠀⠀⣀⣠⠤⠶⠚⠋⠁⠀⠀⡼⡴⠁⢀⠀⢰⣁⣬⡼⢿⢛⠏⡍⠉⢻⣷⡀⠀⠀",
-    "⠀⢀⣾⠏⠀⣼⢿⣿⢸⣿⠀⠃⢳⡀⢻⡀⠀⠀⠀⠀⣀⣠⠴⠞⠛⠉⠉⢀⠀⠀⠀⠀⠀⠀⢰⣁⣼⠶⡞⠋⠋⢱⡀⠇⡞⣸⣸⠀⠁⠈⣿⣷⡄⠀",
-    "⠀⣼⡟⠀⣴⡏⣿⣿⣌⣿⣀⣀⣈⣳⡀⢿⡀⠀⠊⠉⣄⠀⠀⠀⠂⠐⠀⠘⢦⠀⣀⣤⠴⠚⠉⠉⠀⠐⠁⠰⠀⠈⢻⡐⠧⣿⣯⣴⣶⠿⠛⠋⠁⠀",
-    "⣴⣿⠁⣰⣿⣱⣿⣿⠉⢹⠉⣿⡟⠻⣷⠀⢷⡀⠀⠀⠸⣆⢀⢀⣀⡤⠤⠖⠚⠋⠁⠀⠀⠀⢳⡀⠀⠀⠀⣀⣠⣴⣾⣿⣿⣿⣿⣿⣶⣤⠀⠀⠀⠀",
-    "⢿⣷⣶⣿⡿⠟⠛⣿⡀⠀⡗⣽⡇⠀⠙⣦⠈⢧⡀⠀⠄⠘⡟⡍⢠⠳⡔⠀⠀⠀⠀⠀⠀⣀⣀⣷⣴⠿⠛⢻⣿⡏⠈⡶⣿⡿⣏⠉⠈⠹⡇⠀⠀⠀",
-    "⠀⠀⠈⠀⠀⠈⠀⣿⡅⠀⣃⢾⡇⠀⠀⠹⣇⠈⢷⠀⠀⠀⠁⠃⠆⠀⢳⡀⣀⣤⡤⠶⡿⡿⠉⠁⣀⣤⣤⣾⠿⠷⢾⣄⢫⣿⣿⡿⠦⠄⣧⣤⣴⣶",
-    "⠀⠀⠀⠀⠀⠀⠀⣿⠆⠀⣰⢿⡇⠀⠀⠀⢻⣇⠈⢷⠀⠀⠀⣀⣠⣶⣿⣿⣿⣿⣿⣿⣷⣴⠾⠟⠋⠉⣁⣠⣾⣶⡾⢿⣿⣿⠉⣷⡀⢠⣿⣿⣿⣿",
-    "⠀⠀⠀⠀⠀⠀⠀⣿⡃⠀⠏⣿⡇⠀⠀⠀⠀⠻⣷⣬⣷⣾⡿⢻⣻⣷⣙⣷⣍⢿⣟⣿⣿⣦⣼⣿⣿⣾⠿⢿⣿⠇⠀⡝⣾⣿⡀⠹⣿⣿⣿⠟⠋⠀",
-    "⠀⠀⠀⠀⠀⠀⠀⣿⡇⢀⣣⣿⡇⠀⠀⣀⣠⣤⣶⡿⠿⠟⢻⣉⣷⣯⣿⣿⣿⣿⣿⣿⣿⣿⡛⣯⣅⠀⠠⢸⣿⠀⠀⢞⡏⣿⡇⠀⠀⠀⠀⠀⠀⠀",
-    "⠀⠀⠀⠀⠀⠀⠀⣿⡇⠀⣷⣿⠷⠖⠛⠋⠉⣀⣡⣴⣶⣶⣿⣿⣿⣯⡿⠟⠿⢿⣿⢿⣷⡟⠛⠛⠛⢿⣶⣾⣿⠀⠀⢸⡻⣿⣇⡀⠀⠀⠀⠀⠀⠀",
-    "⠀⠀⠀⠀⠀⢀⣴⣿⠃⠘⣿⣿⣠⣤⣤⣾⣟⣛⡉⠉⢿⡄⢀⠉⠉⠁⠀⠀⠀⠀⣹⣿⣿⡿⢄⣠⣠⣾⡁⠀⠹⣆⣀⢹⣿⣿⣛⡿⢷⣦⣄⠀⠀⠀",
-    "⠀⠀⠀⢀⣴⡿⠃⣾⠀⢨⣿⣿⡏⠉⡉⢠⠀⠀⠤⣶⣾⣿⣞⣼⢖⢆⣆⡆⢀⣀⣸⣿⣿⡇⣤⡀⣸⡏⠉⠓⠲⠈⢉⣿⣿⠿⢟⠟⠖⠿⣿⣷⡀⠀",
-    "⠀⠀⢠⣾⣿⠁⢠⣿⠀⢠⣻⣿⣿⣿⣱⣧⣶⣽⣿⣿⣿⣿⣿⣿⣿⣿⣿⣷⣾⣿⣷⣿⣿⣿⣿⣿⣿⣿⣳⠖⠢⡰⡏⠁⠀⠀⠀⠀⠁⠉⣿⣿⡇⠀",
-    "⠀⢠⣿⡏⣿⡴⠟⡇⠀⠀⢪⣿⣿⢫⡽⣿⣿⣿⣿⣿⣿⣿⣿⣿⣿⣿⣿⣿⣽⣿⣯⣿⣿⣿⣽⡿⣭⠻⡝⢿⣿⣿⡿⠶⣄⠀⠀⠀⠀⡴⠃⢸⡇⠀",
-    "⠀⢸⣿⢳⡟⣆⠀⣯⠀⠀⠖⣼⡿⣿⣰⣿⣿⣿⣿⣿⣿⣿⣿⣿⣿⣿⣿⣿⣿⣿⡿⣿⣾⣿⣿⣷⣿⢶⣼⡷⠟⠁⠀⠀⠈⢳⡄⢠⡞⢡⠀⣿⡇⠀",
-    "⠀⢸⣿⣿⡁⢈⠀⠈⠙⠻⠿⠿⣧⡛⣙⢿⣽⣿⣿⣿⣿⣿⣿⣿⣿⣿⣿⣿⣿⡿⠿⠿⠿⠟⠛⠛⠛⠿⣍⠀⠀⠀⠀⠀⣀⣤⣿⢉⠇⡾⣟⣿⡇⠀",
-    "⠀⢸⣿⡏⠄⠀⠑⠀⡀⠀⢠⣀⠀⠀⢀⡾⠻⠃⠀⠀⠀⠈⠉⠉⠉⠉⠻⣏⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠹⣦⠀⠀⢀⣴⢧⢀⣼⣾⢰⢱⢻⣿⠁⠀",
-    "⠀⢸⣿⡆⠐⠀⠀⠀⠀⠀⠀⠈⠙⢻⣟⡦⠄⠀⠀⠀⠀⠀⢀⣀⣀⣀⣀⣽⣦⣤⣤⡤⠤⠤⠖⠒⠋⠀⠘⢽⣇⠀⣼⡟⡌⣸⣼⢣⣟⣿⣾⣿⠀⠀",
-    "⠀⠀⣿⠿⣦⡀⠀⠀⢄⠂⡀⠀⠀⣾⠀⠉⠰⢭⢔⣆⢀⠠⠀⡀⢀⠀⠠⢼⣧⡀⣄⣶⣼⠷⣄⢠⣷⢦⡟⣼⡿⣸⣻⢱⢣⣡⡟⣨⣹⡾⣿⣿⠀⠀",
-    "⠀⠀⣿⣾⣬⠻⣦⣄⠀⠁⠀⠀⣸⠏⠀⠀⠀⠀⠀⠈⠑⠂⠱⣤⡎⢸⣏⣿⣿⡽⣿⣿⡟⣾⣾⣾⣟⣾⣰⣿⣷⣿⣇⣾⣾⣿⣿⢿⢋⣧⣿⣿⠀⠀",
-    "⠀⢠⣿⣿⡯⠙⢹⠛⠛⠶⠦⣾⣿⣦⣀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠘⣿⣿⣽⣿⣿⣿⣿⣹⣿⣿⣣⣿⣿⣾⣾⣿⣿⣿⣏⣅⣾⡞⣽⣸⣿⠀⠀",
-    "⠀⢸⣿⠃⠀⠀⣹⠀⠀⠀⠀⠀⠈⠉⠙⠛⠷⣶⣦⣤⣄⣀⣀⣀⣀⣀⣠⣿⣥⣿⣿⣧⣯⣿⣿⣿⣿⡿⡿⣿⣿⣿⢿⠇⣿⡾⡽⣹⢱⢃⣿⣿⠀⠀",
-    "⠀⢸⣿⡀⠀⠀⡿⠀⠀⠀⠀⠀⠀⠀⢀⠀⠀⠈⢿⡉⠀⠉⠉⣉⠉⠛⠛⠛⠛⠙⡏⣿⣿⣿⣿⣿⣻⡟⢹⣿⢧⣏⡟⢸⢻⣷⢷⢇⣿⣿⢻⣿⠀⠀",
-    "⠀⢸⣿⡷⣦⣰⣇⠀⠀⠀⠀⠀⢄⡔⠄⠛⠀⠀⣸⡅⠀⠀⠉⠀⠀⠀⠀⠀⠀⠀⣼⣿⣻⣻⢷⣿⣿⢃⣿⡟⡿⣸⢱⣿⣿⣷⣿⡿⣿⣿⣿⣿⠀⠀",
-    "⠀⢸⣿⣽⡎⠛⠿⢷⣤⣤⣀⡀⠀⠀⠀⠀⠀⣸⡿⠀⠀⠀⡀⡀⢴⡖⢱⢄⠀⠀⢻⣷⣿⣟⡟⣼⣧⣼⣿⣿⣷⣧⣿⣾⣿⡿⢸⢳⣿⣧⢹⣿⠀⠀",
-    "⠀⠸⣿⡏⠀⠀⠀⠀⠀⠈⠉⢻⡿⠛⣷⠶⠿⠿⠿⠶⣤⣿⣿⣯⣿⣧⣯⣿⣧⣤⣿⣿⣿⣾⣿⡿⣿⢿⢿⠏⣿⣿⢱⣯⣿⣡⣯⣿⣿⣿⣹⣿⠀⠀",
-    "⠀⠀⠙⢿⣦⣄⡀⠀⠀⠀⠀⢸⡗⠀⠠⠀⠀⠀⠀⠀⠀⠀⠉⠉⠉⠉⠉⢿⠋⠉⠉⣹⣿⢳⣿⢧⣿⣿⡟⢰⢿⡏⣾⣿⢃⡟⣼⣽⣿⣿⡿⠋⠀⠀",
-    "⠀⠀⠀⠀⠈⠛⠻⢷⣦⣤⣤⣼⣇⠀⠀⠀⠀⠀⠀⢀⠈⡀⡀⠄⠀⠀⠀⣸⠀⠀⠀⢻⣿⣿⡏⣾⡿⣹⡁⢿⣿⣀⣿⣿⣾⡿⠿⠛⠉⠀⠀⠀⠀⠀",
-    "⠀⠀⠀⠀⠀⠀⠀⠀⠈⠉⠛⠻⠿⢿⣷⣾⣶⣿⣶⣿⣍⣁⣁⣀⣀⣀⣰⣯⣀⣼⣿⣀⣘⣹⣧⣴⣷⣿⡿⠿⠟⠛⠋⠉⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀",
-    "⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠈⠉⠉⠛⠛⠛⠛⠛⠛⠛⠛⠛⠛⠛⠛⠛⠛⠛⠋⠉⠉⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀",
-    "⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⢀⢀⠀⡀⢀⠀⡀⢀⠀⡀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀⠀ "
-};
-
-char const* const door_art[] = {
-    "              ________",
-    "             / ______ \\",
-    "             || _  _ ||",
-    "             ||| || |||",
-    "             |||_||_|||",
-    "             || _  _o||    ",
-    "             ||| || |||",
-    "             |||_||_|||      ^~^  ,",
-    "             ||______||     ('Y') )",
-    "            /__________\\    /   \\/",
-    "    ________|__________|__ (\\|||/) _________",
-    "           /____________\\",
-    "           |____________|",
-};
-
-char const* const freaky_apple_art[55] = {
-
-"                                       *%##*-==--------=*@@                                         ",
-"                              ******++*#%###+==---------===--+%                                     ",
-"                      *=---=--========--*#***==------------=====-+##+=-======*#@                    ",
-"                  %#*+==================-=***+=-------------==+==+++===========+=+#                 ",
-"               %#***+=-====-----==++=======*+*========--====++++++====---====+++++++*%              ",
-"             %#********+++==================*+*=====-====+=++++======------==++*+***+**@            ",
-"           %#*#********++============+==++===+*+----:----============----==+++*+********#@          ",
-"          #####*#**+*+++++===========-=======-======---=====---------====+++++***********#%         ",
-"        %*####+*++===-=====++===-=============-=--=-----=----------====+++++****#*#########%        ",
-"       #+###***+*+===-=--=============--==--=-----------------=--==-=+=++********########**#%       ",
-"      %=*%#**+***+++==--===------======-----------------------=======+*+++**#+*##**##%%#*####       ",
-"     @=+##****##***++=====---==-====-========----------============+=+++**+*###*##*#*#%%%####%      ",
-"     +=##***########+*+==++==++++++++==+=====---=-----==========++=++++*****###%######*##%%%##@     ",
-"    *-*#****#%#####+##**++++**+****+*+*++++============+++=++++=+++****+#***##%#########*##%%#%@    ",
-"    -=#***###%##%####*********+*********+++++====+++++++++++=++*+***+***#*****##%###########%%%%    ",
-"   %=****#%#%#%######*####***+=+*******+**+++++==++++++++***+=+**#******+*#**+*#%#%#**#####%#%%#%   ",
-"   ++#####%%###%####***#**#**+++********++++++++++**+**+**+*+++*********##******%###*****##%#%%%#   ",
-"   -*#######%#*#####*#**##**+++*#*+*#*+==+*++===-=+*+***+*++**+*#++##******##*##*##**++*##%%%%%%#%  ",
-"   -*#####+*####%######**********++*+++==++=--:--==+**+*****#**##*+##**##**##*###**++=+*#%#%%%%%#%  ",
-"  @=*#%###*+*##%######***###*****+++++++++=-:::--==++++*******###***######*#####*+=-:=**%%%%%%%###  ",
-"  %**#%%###****#%#####***###*#***+++*++++==-:::=-=++++*******####*##**+#######*##==++*##%%%%%%%###  ",
-"  ##**#%#%%####%%#%##**#*##*##***++++***+===--===+++*********###***#*###*####%#*#*+++#%##%%%%%####  ",
-"  #####%%%#######%%##*#*####*#***+*******+++====+***+=******#***##*##*##########%%##%%%%%%%%%##%##  ",
-"  ##*######%%####%%%########****#+***+****++++++************#*#*###########%####%%%%%%%%%%%%%%@%#%  ",
-"  %*##########%###%%####**#***********#*******+****###**#*#*####*#%#%%%%#%%%%%%%%@@%%%%%%%%%%@@@*%  ",
-"   +###########%%%#####***##+**#*#####***###*******#####*###%##%##%#%%%%*#%%%%%%%%@%@@@%@%%@@@%@*%  ",
-"   +*##########%%%%%###**###*###*##*####*####*##########%#####%#%###%##%%%%%%%%%%%%%%%@%#%@@@@@@+@  ",
-"   #+****#**#*#####%#############%#####***##%###*#####*####%##%%%%%%%%%%%%%%%@%%%%%%%%%#%%@@@%%%*   ",
-"    *+**#******##%#=-%@%%%@@@%%#*%########*#%##*+*##*###%##%%%%%%%%%%%@@%%@%@@@#*##%%%%%%%%%%%%##   ",
-"    *+*##******##*=:-=@@@@@@@@%==##*######*###########%%%%%%%%%%%%%+==%@@@@@@@#*##%%#%@%%%%%%%%#@   ",
-"     =*#***+++**#%#%*=-=%@@@@#=--==+*%%##*##*#########%%%%%##%%%%##*****#%%%%%%#%%##%@%%%%##%##*@   ",
-"     #***+*++++**##%%%%%########**#**#################%%%%%%%%%%%%%%%%#%%%%%%%%%#%%%%%%%######*#    ",
-"      *+**++*+++*###%#%####*#%%####*#####*####*#######%%%%%%%%%%%%%%%%%@@%%#%%%%%%%%%%%######**@    ",
-"       =+++++%+++***###%#######%####################*#%%%%%%%%%%%%%%%@@@@%%%@%%%%%%%%%##**##*+@     ",
-"       *=+++++@*++**###%#####%##%####################*%%%%%%%%%%%%%%%%%%%@@%%%%%@@%%%%#**#*#*%      ",
-"        #++++++%@+++**##########*####%#################%%%%%%##%###%%%%%@%%%%%%@@%%%@#**#***#       ",
-"         *++++++#@%+***##**####*#######################%%%%%%%####%%%%%%%%%%%@@@@%@@%#***+*#        ",
-"          *+++=+++@@@****#####################**%######%%%%%##%%%%%%#%%%%%%%%%%#%%@%%#*#*+*         ",
-"           +++===++@@@-***####***#*############%%######%%#%%%##%%%%%%%%%%%#**+-@#%%%####**          ",
-"            =+===++*%@@%:::-=+++*#####*############*###%%%#%%%####***+++=:-::=#%%%%%###*+@          ",
-"            %===+++***@@@@-::...::.....:..........:.........:......:-...::-+==@@%%%%##*+@           ",
-"             %+=++++***=%@@@-...::.....:..........-.........:......:-...*@@@@=@%%%%##**%            ",
-"              #==++*****+:-@@@@+::.....:....    ..:.    ....:......:=*@@@@@@%-%%%%%##+%             ",
-"               *==++***##:.:@@@@@@+-...:....    ..:.     ...:....=#@@@@@@*=%%:##%%##+#              ",
-"                *==++***=-:.:%@@@@++++++++-.......-.......:=+++++++@@@@@:-%%%%%%%%#**               ",
-"                 +=++*##=::::::@@%++++++++++++++++++++++++=++++++++@@+.:-*%%###%%#*#                ",
-"                  *=+*##*:.::...@%++++++++++++++++++++++++-=+++++++@.::*++%%%##%%##                 ",
-"                   *=+**#:.:+:::.-+++=========++++++++====--====+++-::-%*+%%%%%%#@                  ",
-"                     =*###..#*#-::=+=====-=======++================--:*%-%%#%%%%                    ",
-"                      *=+*:.*#***--=====--------=====-------======-**=%-+###%#%                     ",
-"                        #=:.*##**=-=====--------=====---:-::--=====####-#####@                      ",
-"                          :.*####*--=+===--:::--====---::::---====####=+###@                        ",
-"                 #       *::* %**#+======---:---====---::---===++#####**#@                          ",
-"                         *::-    @@%*=====------=====------====#######**                            ",
-"                         =:.:       #=*:===-.:-======----===+:%%%%%%@@=+                            ",
-};
-
-
-char const* const gudrun_art[16] = {
-"         .---.",
-"        (_---_)",
-"       (_/6 6\\_)",
-"        (  v  )",
-"         `\\ /'",
-"      .-'': ;``-.",
-"     /   \\,Y./   \\",
-"    /     (:)___  \\",
-"   :   .-'XXX`-.`\\_;",
-"    `.__.-XXX-.__.'\\_",
-"     /  / XXX \\  \\   `\\_",
-"    /      XXX    \\     `\\",
-"   /        XXX    \\     _`\\___",
-"  /                 \\  (`--\"\"\"-')",
-" /                   \\ (=-=-=-=-)",
-" `--...___   ___...--' (________)",
-};
-
-// clang-format on
-
 /********************** COMMANDS **********************/
 
 static Return_command const exit_game = {
@@ -220,7 +38,7 @@ const struct Option options_back = {.label = "Back", .command = (Command*)&pop};
 
 struct Option const* const options[] = {&options_language, &options_katte,
                                         &options_colour, &options_back};
-MAKE_MENU(options, NULL, 60, -1, -1); //NOLINT
+MAKE_MENU(options, NO_BANNER, 60, -1, -1); //NOLINT
 
 /********************* START MENU *********************/
 
@@ -232,7 +50,7 @@ Option const start_exit    = {.label = "Exit", .command = (Command*)&exit_game};
 
 Option const* const start[] = {&start_play, &start_options, &start_exit};
 
-MAKE_MENU(start, title, 77, -1, -1); //NOLINT
+MAKE_MENU(start, TITLE_BANNER, 77, -1, -1); //NOLINT
 
 /************************ CABIN ************************/
 
@@ -242,7 +60,7 @@ Option const cabin_back  = {.label   = "Go back",
 
 Option const* const cabin[] = {&cabin_knock, &cabin_back};
 
-MAKE_MENU(cabin, door_art, 100, -1, -1); //NOLINT
+MAKE_MENU(cabin, DOOR_BANNER, 100, -1, -1); //NOLINT
 MAKE_MENU_COMMAND(cabin);
 
 /********************** APPLE **********************/
@@ -257,7 +75,7 @@ Option const glade_forest = {.label   = "Forest",
                              .command = (Command*)&null_command};
 Option const* const glade[] = {&glade_cabin, &glade_well, &glade_forest};
 
-MAKE_MENU(glade, questionmark, 100, -1, -1); //NOLINT
+MAKE_MENU(glade, QUESTIONMARK_BANNER, 100, -1, -1); //NOLINT
 
 /************************ WELL ************************/
 
@@ -272,7 +90,7 @@ const struct Option well_back = {.label = "Back", .command = (Command*)&pop};
 
 struct Option const* const well[] = {&well_raise_bucket, &well_back};
 
-MAKE_MENU(well, well_art, 50, -1, -1); //NOLINT
+MAKE_MENU(well, WELL_BANNER, 50, -1, -1); //NOLINT
 
 /************************ GUDRUN ************************/
 
@@ -283,11 +101,22 @@ Option const gudrun_back  = {.label   = "Return",
 
 Option const* const gudrun[] = {&gudrun_speak, &gudrun_back};
 
-MAKE_MENU(gudrun, gudrun_art, 0, -1, -1); //NOLINT
+MAKE_MENU(gudrun, GUDRUN_BANNER, 0, -1, -1); //NOLINT
 MAKE_MENU_COMMAND(gudrun);
 
 /*****************************************************/
 
+struct Menu const* const all_menus[] = {
+    &implementation_start_menu, &implementation_options_menu,
+    &implementation_glade_menu, &implementation_well_menu,
+    &implementation_cabin_menu, &implementation_gudrun_menu,
+};
+
+char const* const all_menu_names[] = {"start", "options", "glade",
+                                      "well",  "cabin",   "gudrun"};
+
+int const all_menus_len = sizeof(all_menus) / sizeof(all_menus[0]);
+
 //! Initialises all the runtime information of the menus defined in \ref
 //! menu_constants.c
 void initialise_menus(void)
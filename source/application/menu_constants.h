@@ -29,8 +29,12 @@ extern Menu_command const show_cabin;
 EXTERN_MENU(gudrun);
 extern Menu_command const show_gudrun;
 
-extern char const* const freaky_apple_art[55];
-extern char const* const gudrun_art[16];
+//! Every menu defined in \ref menu_constants.c, e.g. for tools walking the
+//! scene graph
+extern struct Menu const* const all_menus[];
+//! The names of the menus in \ref all_menus, in the same order
+extern char const* const all_menu_names[];
+extern int const all_menus_len;
 
 void initialise_menus(void);
 
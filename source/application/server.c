@@ -0,0 +1,1465 @@
+/*!
+ * \file server.c
+ * \brief Implementation file for \ref server.h
+ *
+ * Every connection gets its own ncurses SCREEN (through newterm) and \ref
+ * Context, and plays \ref run_game on a coroutine with a stack of its own.
+ * Whenever the game needs a key that hasn't arrived yet, \ref read_key calls
+ * \ref wait_for_input, which switches back to the event loop. The loop resumes
+ * the session once its client has sent more bytes.
+ *
+ * ncurses reads keys from, and writes the screen to, a pipe in each direction.
+ * The loop moves bytes between those pipes and the client socket through
+ * per-session buffers, so that a slow client never blocks the other sessions.
+ *
+ * All sessions share one terminal type (TERM) and size (LINES and COLUMNS),
+ * since the menus are laid out once for the whole process.
+ *
+ * A SCREEN is never deleted, see \ref Terminal. When a session ends, its
+ * SCREEN and pipes are kept for the next session, so there are never more of
+ * them than there were sessions at the busiest time.
+ *
+ * ncurses keeps the current SCREEN in a global, so sessions cannot be spread
+ * over threads. \ref serve_sharded instead forks one worker process per shard,
+ * each pinned to a CPU and running the same loop. The parent accepts the
+ * connections and passes each one to the least busy worker over a socketpair
+ * (SCM_RIGHTS). Every worker keeps its \ref Shard_stats in memory shared with
+ * the parent, which logs them periodically.
+ *
+ * \ref serve_prefork is the simplest host: it forks a process per connection
+ * that plays on the socket directly, sharing the menus and dialogues loaded by
+ * \ref init_server with the parent copy-on-write.
+ *
+ * A session that has been waiting for input at a \ref Context::checkpoint for
+ * longer than the idle timeout is hibernated: it is written to a snapshot in
+ * an unlinked temporary file and everything but its socket is released. The
+ * next key from its client restores it from the checkpoint.
+ *
+ * Spectators connect to a second listener and name the session they want to
+ * watch. What ncurses writes for a session is read once into reference
+ * counted \ref Chunk "chunks", which are queued for the player and for every
+ * \ref Watcher without being copied. A watcher that falls too far behind has
+ * its backlog dropped and is sent a copy of the whole screen instead, so it
+ * never holds up the player. That copy is drawn by ncurses at most once per
+ * frame, however many watchers need it.
+ *
+ * If a recording directory is set, the same output is also passed to a \ref
+ * Recorder per session, whose files are written by a thread of their own.
+ */
+#define _GNU_SOURCE
+
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <locale.h>
+#include <ncurses.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "accounting.h"
+#include "base.h"
+#include "io/logging.h"
+#include "io/recorder.h"
+#include "io/utf8.h"
+#include "menu.h"
+#include "menu_constants.h"
+#include "server.h"
+#include "snapshot.h"
+#include "start.h"
+#include "state.h"
+#include "window_pool.h"
+
+enum
+{
+    SESSION_STACK_SZ = 256 * 1024,
+    //! Large enough for ncurses to write a full frame without blocking
+    OUTPUT_PIPE_SZ = 1024 * 1024,
+    //! Sessions whose client falls further behind than this are dropped
+    MAX_PENDING_OUTPUT = 8 * 1024 * 1024,
+    IO_CHUNK_SZ        = 4096,
+    //! Most bytes read from the output pipe of a session at once
+    OUTPUT_READ_SZ = 64 * 1024,
+    //! Watchers further behind than this skip ahead to a copy of the screen
+    MAX_WATCHER_BACKLOG = 256 * 1024,
+    //! Longest request a watcher may send before naming a session
+    WATCH_REQUEST_SZ = 32,
+    //! Most chunks passed to one writev call
+    WRITE_BATCH = 64,
+    MAX_EVENTS         = 64,
+    LISTEN_BACKLOG     = 128,
+    ESC_DELAY_MS       = 25,
+    //! Seconds between two logs of the shard statistics
+    STATS_INTERVAL_S = 60,
+    DEFAULT_IDLE_TIMEOUT_S = 300,
+    //! How often idle sessions are looked for, if hibernation is enabled
+    IDLE_SCAN_MS = 1000
+};
+
+//! Terminal used for sessions unless TERM, LINES and COLUMNS say otherwise
+#define DEFAULT_TERM    "xterm-256color"
+#define DEFAULT_LINES   "60"
+#define DEFAULT_COLUMNS "200"
+
+//! Growable byte buffer
+typedef struct Buffer
+{
+    char* data;
+    size_t len;
+    size_t cap;
+} Buffer;
+
+/*!
+ * \brief A piece of the output of a session
+ *
+ * Chunks are immutable once queued, and freed when the last \ref Out_queue
+ * holding them has sent them.
+ */
+typedef struct Chunk
+{
+    int refs;
+    size_t len;
+    char data[];
+} Chunk;
+
+//! Chunks waiting to be sent on one socket, oldest first, in a ring buffer
+typedef struct Out_queue
+{
+    Chunk** chunks;
+    int first;
+    int count;
+    int cap;
+    //! Bytes of the oldest chunk that have been sent already
+    size_t sent;
+    //! Bytes queued but not yet sent
+    size_t pending;
+} Out_queue;
+
+//! Tells the kinds of sockets in the loop apart, first member of each
+typedef enum Peer_kind
+{
+    peer_player,
+    peer_watcher
+} Peer_kind;
+
+struct Session;
+
+//! A spectator following a session
+typedef struct Watcher
+{
+    Peer_kind kind;
+    int fd;
+    //! The session watched, NULL until the watcher has named one
+    struct Session* session;
+    //! The request naming the session, until its newline has arrived
+    char request[WATCH_REQUEST_SZ];
+    size_t request_len;
+    Out_queue out;
+    //! Set when the output queued so far must be followed by a full screen
+    bool needs_screen;
+    //! Set while the socket is polled for writability
+    bool polling_out;
+    //! The watchers of a session form a singly linked list
+    struct Watcher* next;
+} Watcher;
+
+typedef struct Session
+{
+    Peer_kind kind;
+    //! Number watchers name the session by
+    int id;
+    //! Socket connected to the player
+    int client;
+    //! Keys flow from [1] (written by the loop) to [0] (read by ncurses)
+    int input[2];
+    //! The screen flows from [1] (written by ncurses) to [0] (read by loop)
+    int output[2];
+    FILE* in_file;
+    FILE* out_file;
+    SCREEN* screen;
+    Context* ctx;
+    ucontext_t uc;
+    void* stack;
+    //! Set while the session is blocked in \ref wait_for_input
+    bool waiting;
+    //! Set once \ref run_game has returned
+    bool done;
+    //! Set while the client socket is polled for writability
+    bool polling_out;
+    //! Bytes received from the client but not yet passed to ncurses
+    Buffer in;
+    //! Output of ncurses not yet sent to the client
+    Out_queue out;
+    //! Everyone watching the session
+    Watcher* watchers;
+    //! Copy of the whole screen drawn for watchers since the last frame
+    Chunk* screen_copy;
+    //! Recording of everything sent to the player, or NULL
+    Recorder* recorder;
+    //! Snapshot of a hibernating session, NULL while the session is awake
+    FILE* snapshot;
+    //! When the client last sent anything
+    time_t last_input;
+    //! The sessions of a shard form a doubly linked list
+    struct Session* prev;
+    struct Session* next;
+} Session;
+
+/*!
+ * \brief A SCREEN left by a finished session, with the pipes it was opened on
+ *
+ * delscreen frees the windows of every SCREEN in the process, not just those
+ * of the one deleted, so SCREENs are never deleted but kept for the next
+ * session instead. Every one of them is kept: a SCREEN left behind could never
+ * be freed, along with the windows and pads made for it.
+ */
+typedef struct Terminal
+{
+    SCREEN* screen;
+    int input[2];
+    int output[2];
+    FILE* in_file;
+    FILE* out_file;
+    struct Terminal* next;
+} Terminal;
+
+/*!
+ * \brief Counters kept by each shard, readable by the acceptor
+ *
+ * A frame is one run of a session between two waits for input, i.e. the time
+ * it takes to react to a key press.
+ */
+typedef struct Shard_stats
+{
+    atomic_int sessions;
+    atomic_int hibernating;
+    atomic_ullong frames;
+    atomic_ullong frame_ns;
+    atomic_ullong max_frame_ns;
+} Shard_stats;
+
+//NOLINTBEGIN
+static ucontext_t loop_uc;
+//! The session whose coroutine is running, NULL while the loop runs
+static Session* current = NULL;
+static int epoll_fd     = -1;
+//! All sessions of this shard
+static Session* sessions = NULL;
+//! Seconds a session may idle before it is hibernated, 0 to never hibernate
+static int idle_timeout_s = DEFAULT_IDLE_TIMEOUT_S;
+//! Statistics of the shard run by this process
+static Shard_stats* stats = NULL;
+//! Tags telling the listeners and the handoff socket apart from sessions
+static char const listener_tag;
+static char const handoff_tag;
+static char const watch_tag;
+//! Set when watchers may connect, which makes new sessions log their number
+static bool watchable = false;
+static int next_session_id = 1;
+//! Terminals waiting to be reused
+static Terminal* spare_terminals = NULL;
+//! Directory every session is recorded into, or NULL
+static char const* recording_dir = NULL;
+//NOLINTEND
+
+static unsigned long long now_ns(void)
+{
+    struct timespec t;
+    (void)clock_gettime(CLOCK_MONOTONIC, &t);
+    return (unsigned long long)t.tv_sec * 1000000000ULL +
+           (unsigned long long)t.tv_nsec;
+}
+
+static void buffer_append(Buffer* b, char const* data, size_t len)
+{
+    if (b->len + len > b->cap) {
+        size_t cap = b->cap ? b->cap : IO_CHUNK_SZ;
+        while (cap < b->len + len) { cap *= 2; }
+        char* tmp = (char*)realloc(b->data, cap);
+        if (!tmp) { log_and_exit("Out of memory in %s\n", __func__); }
+        b->data = tmp;
+        b->cap  = cap;
+    }
+    memcpy(b->data + b->len, data, len);
+    b->len += len;
+}
+
+static void buffer_consume(Buffer* b, size_t len)
+{
+    memmove(b->data, b->data + len, b->len - len);
+    b->len -= len;
+}
+
+static Chunk* new_chunk(char const* data, size_t len)
+{
+    Chunk* c = (Chunk*)malloc(sizeof(Chunk) + len);
+    if (!c) { log_and_exit("Out of memory in %s\n", __func__); }
+    c->refs = 0;
+    c->len  = len;
+    memcpy(c->data, data, len);
+    return c;
+}
+
+static void release_chunk(Chunk* c)
+{
+    if (c && --c->refs == 0) { free(c); }
+}
+
+static void queue_push(Out_queue* q, Chunk* c)
+{
+    if (q->count == q->cap) {
+        int cap        = q->cap ? q->cap * 2 : 16;
+        Chunk** chunks = (Chunk**)malloc(sizeof(Chunk*) * (size_t)cap);
+        if (!chunks) { log_and_exit("Out of memory in %s\n", __func__); }
+        for (int i = 0; i < q->count; ++i) {
+            chunks[i] = q->chunks[(q->first + i) % q->cap];
+        }
+        free((void*)q->chunks);
+        q->chunks = chunks;
+        q->first  = 0;
+        q->cap    = cap;
+    }
+
+    ++c->refs;
+    q->chunks[(q->first + q->count) % q->cap] = c;
+    ++q->count;
+    q->pending += c->len;
+}
+
+static void queue_pop(Out_queue* q)
+{
+    release_chunk(q->chunks[q->first]);
+    q->first = (q->first + 1) % q->cap;
+    --q->count;
+    q->sent = 0;
+}
+
+//! Marks the next len bytes of q as sent
+static void queue_consume(Out_queue* q, size_t len)
+{
+    q->pending -= len;
+    while (len > 0) {
+        size_t const left = q->chunks[q->first]->len - q->sent;
+        if (len < left) {
+            q->sent += len;
+            return;
+        }
+        len -= left;
+        queue_pop(q);
+    }
+}
+
+/*!
+ * \brief Drops what hasn't started being sent from q
+ *
+ * A chunk that has been sent in part is kept, so that the socket is never
+ * left in the middle of an escape sequence.
+ */
+static void queue_drop_unsent(Out_queue* q)
+{
+    int const keep = q->sent > 0 ? 1 : 0;
+    while (q->count > keep) {
+        --q->count;
+        release_chunk(q->chunks[(q->first + q->count) % q->cap]);
+    }
+    q->pending = keep ? q->chunks[q->first]->len - q->sent : 0;
+}
+
+static void free_queue(Out_queue* q)
+{
+    while (q->count > 0) { queue_pop(q); }
+    free((void*)q->chunks);
+    *q = (Out_queue){0};
+}
+
+/*!
+ * \brief Sends as much of q as fd accepts without blocking
+ *
+ * \returns false if the socket failed
+ */
+static bool queue_write(int fd, Out_queue* q)
+{
+    while (q->count > 0) {
+        struct iovec iov[WRITE_BATCH];
+        int n_iov = 0;
+        for (; n_iov < q->count && n_iov < WRITE_BATCH; ++n_iov) {
+            Chunk* c          = q->chunks[(q->first + n_iov) % q->cap];
+            size_t const skip = n_iov == 0 ? q->sent : 0;
+            iov[n_iov] = (struct iovec){.iov_base = c->data + skip,
+                                        .iov_len  = c->len - skip};
+        }
+
+        ssize_t n = writev(fd, iov, n_iov);
+        if (n >= 0) {
+            queue_consume(q, (size_t)n);
+            continue;
+        }
+        if (errno == EINTR) { continue; }
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+
+    return true;
+}
+
+//! Polls fd for writability exactly while poll_out is set
+static void set_polling_out(int fd, void* peer, bool* polling_out,
+                            bool poll_out)
+{
+    if (poll_out == *polling_out) { return; }
+
+    struct epoll_event ev = {.events   = EPOLLIN | EPOLLRDHUP |
+                                         (poll_out ? EPOLLOUT : 0U),
+                             .data.ptr = peer};
+    (void)epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+    *polling_out = poll_out;
+}
+
+static void set_non_blocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        log_and_exit("fcntl failed in %s: %s\n", __func__, strerror(errno));
+    }
+}
+
+static void close_fd(int fd)
+{
+    if (fd >= 0) { close(fd); }
+}
+
+//! Closes the pipes of a session, and the FILEs opened on them
+static void close_pipes(Session* s)
+{
+    // Closing the FILEs closes the descriptors they were opened on
+    if (s->in_file) { (void)fclose(s->in_file); }
+    else {
+        close_fd(s->input[0]);
+    }
+    if (s->out_file) { (void)fclose(s->out_file); }
+    else {
+        close_fd(s->output[1]);
+    }
+    close_fd(s->input[1]);
+    close_fd(s->output[0]);
+}
+
+//! Reads and discards whatever a pipe holds
+static void discard_pipe(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+    (void)fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    char chunk[IO_CHUNK_SZ];
+    while (read(fd, chunk, sizeof chunk) > 0) {}
+    (void)fcntl(fd, F_SETFL, flags);
+}
+
+//! Ends the screen of a session and keeps it for the next
+static void park_terminal(Session* s)
+{
+    if (!s->done) {
+        set_term(s->screen);
+        endwin();
+    }
+    discard_pipe(s->input[0]);
+    discard_pipe(s->output[0]);
+
+    Terminal* t = (Terminal*)malloc(sizeof(Terminal));
+    if (!t) { log_and_exit("Out of memory in %s\n", __func__); }
+    *t = (Terminal){.screen   = s->screen,
+                    .input    = {s->input[0], s->input[1]},
+                    .output   = {s->output[0], s->output[1]},
+                    .in_file  = s->in_file,
+                    .out_file = s->out_file,
+                    .next     = spare_terminals};
+    spare_terminals = t;
+}
+
+//! Gives a session a spare terminal, or pipes for a new one
+static bool open_terminal(Session* s)
+{
+    Terminal* t = spare_terminals;
+    if (t) {
+        spare_terminals = t->next;
+        s->screen = t->screen;
+        memcpy(s->input, t->input, sizeof s->input);
+        memcpy(s->output, t->output, sizeof s->output);
+        s->in_file  = t->in_file;
+        s->out_file = t->out_file;
+        free(t);
+        return true;
+    }
+
+    if (pipe(s->input) != 0 || pipe(s->output) != 0) {
+        log_msgf("pipe failed in %s: %s\n", __func__, strerror(errno));
+        return false;
+    }
+    // Best effort, the default size fits all but the largest frames
+    (void)fcntl(s->output[0], F_SETPIPE_SZ, OUTPUT_PIPE_SZ);
+    set_non_blocking(s->input[1]);
+    set_non_blocking(s->output[0]);
+
+    s->in_file  = fdopen(s->input[0], "r");
+    s->out_file = fdopen(s->output[1], "w");
+    return s->in_file && s->out_file;
+}
+
+//! Releases everything a session needs to run, leaving its socket open
+static void release_game(Session* s)
+{
+    if (s->screen) { park_terminal(s); }
+    else {
+        close_pipes(s);
+    }
+
+    if (s->ctx) {
+        // The command the coroutine was executing is abandoned with it
+        Command* running = s->ctx->running;
+        if (running && !running->persistent) { tracked_free(running); }
+        free_game_context(s->ctx);
+    }
+    if (s->stack) { munmap(s->stack, SESSION_STACK_SZ); }
+
+    s->screen    = NULL;
+    s->in_file   = NULL;
+    s->out_file  = NULL;
+    s->input[0]  = -1;
+    s->input[1]  = -1;
+    s->output[0] = -1;
+    s->output[1] = -1;
+    s->ctx       = NULL;
+    s->stack     = NULL;
+    s->waiting   = false;
+}
+
+static void close_watcher(Watcher* w)
+{
+    (void)epoll_ctl(epoll_fd, EPOLL_CTL_DEL, w->fd, NULL);
+    if (w->session) {
+        Watcher** link = &w->session->watchers;
+        while (*link != w) { link = &(*link)->next; }
+        *link = w->next;
+    }
+
+    free_queue(&w->out);
+    close_fd(w->fd);
+    free(w);
+}
+
+static void close_session(Session* s)
+{
+    (void)epoll_ctl(epoll_fd, EPOLL_CTL_DEL, s->client, NULL);
+    if (s->prev) { s->prev->next = s->next; }
+    else {
+        sessions = s->next;
+    }
+    if (s->next) { s->next->prev = s->prev; }
+    atomic_fetch_sub(&stats->sessions, 1);
+
+    while (s->watchers) {
+        // Whatever fits into the socket is the watcher's last frame
+        (void)queue_write(s->watchers->fd, &s->watchers->out);
+        close_watcher(s->watchers);
+    }
+
+    release_game(s);
+    if (s->snapshot) {
+        (void)fclose(s->snapshot);
+        atomic_fetch_sub(&stats->hibernating, 1);
+    }
+    close_fd(s->client);
+    free(s->in.data);
+    free_queue(&s->out);
+    release_chunk(s->screen_copy);
+    if (s->recorder) { stop_recording(s->recorder); }
+    free(s);
+}
+
+/*!
+ * \brief Sends as much pending output as the client accepts without blocking
+ *
+ * \returns false if the session was closed
+ */
+static bool flush_output(Session* s)
+{
+    if (!queue_write(s->client, &s->out)) {
+        close_session(s);
+        return false;
+    }
+
+    if (s->done && s->out.pending == 0) {
+        close_session(s);
+        return false;
+    }
+    if (s->out.pending > MAX_PENDING_OUTPUT) {
+        log_msgf("Dropping a session whose client stopped reading\n");
+        close_session(s);
+        return false;
+    }
+
+    set_polling_out(s->client, s, &s->polling_out, s->out.pending > 0);
+
+    return true;
+}
+
+/*!
+ * \brief Returns a copy of the whole screen of a session for its watchers
+ *
+ * ncurses redraws the screen from scratch into the output pipe, which the
+ * loop always leaves empty. The copy is kept until the session's next frame,
+ * so that every watcher needing it during one frame shares it.
+ *
+ * \returns The copy, or NULL while the session cannot draw
+ */
+static Chunk* get_screen_copy(Session* s)
+{
+    if (s->screen_copy) { return s->screen_copy; }
+    if (!s->screen || !s->waiting) { return NULL; }
+
+    set_term(s->screen);
+    (void)clearok(curscr, TRUE);
+    (void)doupdate();
+
+    Buffer screen = {0};
+    char chunk[IO_CHUNK_SZ];
+    ssize_t n = 0;
+    while ((n = read(s->output[0], chunk, sizeof chunk)) > 0) {
+        buffer_append(&screen, chunk, (size_t)n);
+    }
+    if (screen.len > 0) {
+        s->screen_copy = new_chunk(screen.data, screen.len);
+        ++s->screen_copy->refs;
+    }
+    free(screen.data);
+
+    return s->screen_copy;
+}
+
+/*!
+ * \brief Sends as much pending output as a watcher accepts without blocking
+ *
+ * \returns false if the watcher was closed
+ */
+static bool flush_watcher(Watcher* w)
+{
+    while (true) {
+        if (!queue_write(w->fd, &w->out)) {
+            close_watcher(w);
+            return false;
+        }
+        if (!w->needs_screen || w->out.count > 0) { break; }
+
+        Chunk* screen = get_screen_copy(w->session);
+        if (!screen) { break; }
+        queue_push(&w->out, screen);
+        w->needs_screen = false;
+    }
+
+    set_polling_out(w->fd, w, &w->polling_out, w->out.pending > 0);
+
+    return true;
+}
+
+//! Queues output of a session for its player and all its watchers
+static void publish(Session* s, Chunk* c)
+{
+    release_chunk(s->screen_copy);
+    s->screen_copy = NULL;
+
+    queue_push(&s->out, c);
+    for (Watcher* w = s->watchers; w; w = w->next) {
+        if (w->needs_screen) { continue; }
+        queue_push(&w->out, c);
+        if (w->out.pending > MAX_WATCHER_BACKLOG) {
+            queue_drop_unsent(&w->out);
+            w->needs_screen = true;
+        }
+    }
+}
+
+//! Moves everything ncurses has written into the output queues and flushes
+//! them
+static bool drain_output(Session* s)
+{
+    char chunk[OUTPUT_READ_SZ];
+    ssize_t n = 0;
+    while ((n = read(s->output[0], chunk, sizeof chunk)) > 0) {
+        if (s->recorder) { record_output(s->recorder, chunk, (size_t)n); }
+        publish(s, new_chunk(chunk, (size_t)n));
+    }
+
+    Watcher* next = NULL;
+    for (Watcher* w = s->watchers; w; w = next) {
+        next = w->next;
+        (void)flush_watcher(w);
+    }
+
+    return flush_output(s);
+}
+
+//! \ref Input_wait that suspends the running session until input arrives
+static void wait_for_input(void)
+{
+    Session* s = current;
+    s->waiting = true;
+    if (swapcontext(&s->uc, &loop_uc) == -1) {
+        log_and_exit("swapcontext failed in %s\n", __func__);
+    }
+    s->waiting = false;
+}
+
+//! Entry point of the coroutine of a session
+static void session_main(void)
+{
+    Session* s = current;
+
+    if (s->screen) {
+        // A spare terminal, which resumes with the first refresh
+        set_term(s->screen);
+        (void)flushinp();
+        // The windows of an abandoned session aren't on screen anymore
+        forget_layers();
+    }
+    else {
+        s->screen = newterm(NULL, s->out_file, s->in_file);
+    }
+    if (s->screen) {
+        (void)configure_screen();
+        set_escdelay(ESC_DELAY_MS);
+        Command* checkpoint = s->ctx->checkpoint;
+        if (checkpoint) {
+            s->ctx->checkpoint = NULL;
+            resume_game(s->ctx, checkpoint);
+        }
+        else {
+            run_game(s->ctx);
+        }
+        endwin();
+    }
+    else {
+        log_msgf("newterm failed for a new session\n");
+    }
+
+    s->done = true;
+}
+
+/*!
+ * \brief Runs the coroutine of a session until it waits for input or finishes
+ *
+ * \returns false if the session was closed
+ */
+static bool resume(Session* s)
+{
+    unsigned long long const start = now_ns();
+    if (s->screen) { set_term(s->screen); }
+    current = s;
+    if (swapcontext(&loop_uc, &s->uc) == -1) {
+        log_and_exit("swapcontext failed in %s\n", __func__);
+    }
+    current = NULL;
+
+    unsigned long long const frame = now_ns() - start;
+    atomic_fetch_add(&stats->frames, 1);
+    atomic_fetch_add(&stats->frame_ns, frame);
+    // Only this shard writes its maximum
+    if (frame > atomic_load(&stats->max_frame_ns)) {
+        atomic_store(&stats->max_frame_ns, frame);
+    }
+
+    return drain_output(s);
+}
+
+//! Passes the keys received from the client to a waiting session
+static void feed_input(Session* s)
+{
+    while (s->waiting && s->in.len > 0) {
+        ssize_t n = write(s->input[1], s->in.data, s->in.len);
+        if (n <= 0) { return; }
+        buffer_consume(&s->in, (size_t)n);
+        if (!resume(s)) { return; }
+    }
+}
+
+/*!
+ * \brief Starts the game of a session on a coroutine of its own
+ *
+ * The game starts from the \ref Context::checkpoint of ctx if it has one, and
+ * from the opening otherwise.
+ *
+ * \returns false if the session was closed
+ */
+static bool start_game_in(Session* s, Context* ctx)
+{
+    s->ctx = ctx;
+    bool const opened = open_terminal(s);
+    s->stack = mmap(NULL, SESSION_STACK_SZ, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (s->stack == MAP_FAILED) { s->stack = NULL; }
+    if (!opened || !s->stack) {
+        log_msgf("Failed to allocate a session in %s\n", __func__);
+        close_session(s);
+        return false;
+    }
+    // Guard page, so that a stack overflow crashes instead of corrupting
+    (void)mprotect(s->stack, (size_t)sysconf(_SC_PAGESIZE), PROT_NONE);
+
+    if (getcontext(&s->uc) == -1) {
+        log_and_exit("getcontext failed in %s\n", __func__);
+    }
+    s->uc.uc_stack.ss_sp   = s->stack;
+    s->uc.uc_stack.ss_size = SESSION_STACK_SZ;
+    s->uc.uc_link          = &loop_uc;
+    makecontext(&s->uc, session_main, 0);
+
+    return resume(s);
+}
+
+static void new_session(int client)
+{
+    Session* s = (Session*)calloc(1, sizeof(Session));
+    if (!s) { log_and_exit("Out of memory in %s\n", __func__); }
+    *s = (Session){.kind       = peer_player,
+                   .id         = next_session_id++,
+                   .client     = client,
+                   .input      = {-1, -1},
+                   .output     = {-1, -1},
+                   .last_input = time(NULL),
+                   .next       = sessions};
+    if (sessions) { sessions->prev = s; }
+    sessions = s;
+    atomic_fetch_add(&stats->sessions, 1);
+
+    set_non_blocking(client);
+    struct epoll_event ev = {.events = EPOLLIN | EPOLLRDHUP, .data.ptr = s};
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client, &ev) == -1) {
+        log_msgf("epoll_ctl failed in %s: %s\n", __func__, strerror(errno));
+        close_session(s);
+        return;
+    }
+
+    if (watchable) { log_msgf("Session %d started\n", s->id); }
+    if (recording_dir) {
+        // Shards number their sessions independently
+        char path[PATH_MAX];
+        (void)snprintf(path, sizeof path, "%s/%d-%d.cast", recording_dir,
+                       (int)getpid(), s->id);
+        s->recorder = start_recording(path, atoi(getenv("COLUMNS")),
+                                      atoi(getenv("LINES")));
+    }
+    (void)start_game_in(s, new_game_context());
+}
+
+//! Puts a session waiting at a checkpoint away until its client sends a key
+static void hibernate(Session* s)
+{
+    FILE* snapshot = tmpfile();
+    if (!snapshot || !write_snapshot(snapshot, s->ctx)) {
+        log_msgf("Failed to hibernate a session\n");
+        if (snapshot) { (void)fclose(snapshot); }
+        // Not worth retrying before it has idled again
+        s->last_input = time(NULL);
+        return;
+    }
+
+    release_game(s);
+    s->snapshot = snapshot;
+    atomic_fetch_add(&stats->hibernating, 1);
+}
+
+/*!
+ * \brief Restores a hibernating session
+ *
+ * \returns false if the session was closed
+ */
+static bool wake(Session* s)
+{
+    rewind(s->snapshot);
+    Context* ctx = read_snapshot(s->snapshot);
+    (void)fclose(s->snapshot);
+    s->snapshot = NULL;
+    atomic_fetch_sub(&stats->hibernating, 1);
+
+    if (!ctx) {
+        log_msgf("Failed to restore a hibernated session\n");
+        close_session(s);
+        return false;
+    }
+
+    return start_game_in(s, ctx);
+}
+
+static void hibernate_idle_sessions(void)
+{
+    time_t const now = time(NULL);
+    for (Session* s = sessions; s; s = s->next) {
+        // Watched sessions stay awake, so that new watchers see them at once
+        if (!s->snapshot && s->waiting && s->ctx->checkpoint &&
+            !s->watchers && s->in.len == 0 && s->out.pending == 0 &&
+            now - s->last_input > idle_timeout_s) {
+            hibernate(s);
+        }
+    }
+}
+
+static void new_watcher(int fd)
+{
+    Watcher* w = (Watcher*)calloc(1, sizeof(Watcher));
+    if (!w) { log_and_exit("Out of memory in %s\n", __func__); }
+    w->kind = peer_watcher;
+    w->fd   = fd;
+
+    set_non_blocking(fd);
+    struct epoll_event ev = {.events = EPOLLIN | EPOLLRDHUP, .data.ptr = w};
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        log_msgf("epoll_ctl failed in %s: %s\n", __func__, strerror(errno));
+        close_fd(fd);
+        free(w);
+    }
+}
+
+static void accept_clients(int listener, void (*add)(int))
+{
+    while (true) {
+        int client = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+        if (client >= 0) {
+            add(client);
+            continue;
+        }
+        if (errno == EINTR || errno == ECONNABORTED) { continue; }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            log_msgf("accept failed in %s: %s\n", __func__, strerror(errno));
+        }
+        return;
+    }
+}
+
+static void handle_client(Session* s, uint32_t events)
+{
+    if ((events & EPOLLOUT) && !flush_output(s)) { return; }
+    if (!(events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) { return; }
+
+    char chunk[IO_CHUNK_SZ];
+    while (true) {
+        ssize_t n = read(s->client, chunk, sizeof chunk);
+        if (n > 0) {
+            buffer_append(&s->in, chunk, (size_t)n);
+            s->last_input = time(NULL);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) { continue; }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) { break; }
+
+        // The client hung up
+        close_session(s);
+        return;
+    }
+
+    if (s->snapshot && !wake(s)) { return; }
+    feed_input(s);
+}
+
+/*!
+ * \brief Attaches a watcher to the session named by its request
+ *
+ * The request is a session number, or an empty line for the newest session.
+ * The watcher is closed if there is no such session.
+ */
+static void attach_watcher(Watcher* w)
+{
+    int id = 0;
+    if (w->request_len > 0 && sscanf(w->request, "%d", &id) != 1) { id = -1; }
+
+    Session* s = sessions;
+    while (s && id != 0 && s->id != id) { s = s->next; }
+    if (!s) {
+        char const msg[] = "No such session\r\n";
+        (void)send(w->fd, msg, sizeof msg - 1, MSG_NOSIGNAL);
+        close_watcher(w);
+        return;
+    }
+
+    w->session      = s;
+    w->needs_screen = true;
+    w->next         = s->watchers;
+    s->watchers     = w;
+    // Waking the session flushes its watchers
+    if (s->snapshot) { (void)wake(s); }
+    else {
+        (void)flush_watcher(w);
+    }
+}
+
+static void handle_watcher(Watcher* w, uint32_t events)
+{
+    if ((events & EPOLLOUT) && !flush_watcher(w)) { return; }
+    if (!(events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) { return; }
+
+    char chunk[IO_CHUNK_SZ];
+    while (true) {
+        ssize_t n = read(w->fd, chunk, sizeof chunk);
+        if (n < 0 && errno == EINTR) { continue; }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) { return; }
+        if (n <= 0) {
+            close_watcher(w);
+            return;
+        }
+        // Keys sent once watching are ignored
+        if (w->session) { continue; }
+
+        for (ssize_t i = 0; i < n && !w->session; ++i) {
+            if (chunk[i] == '\n' || chunk[i] == '\r') {
+                w->request[w->request_len] = '\0';
+                attach_watcher(w);
+                // The watcher may have been closed
+                return;
+            }
+            if (w->request_len + 1 == sizeof w->request) {
+                close_watcher(w);
+                return;
+            }
+            w->request[w->request_len++] = chunk[i];
+        }
+    }
+}
+
+/*!
+ * Sets the locale, the terminal defaults, and lays out the menus once for all
+ * sessions on a screen that is never shown.
+ */
+void init_server(void)
+{
+    set_log_output(stderr);
+    if (!setlocale(LC_ALL, "")) { log_and_exit("Error setting locale\n"); }
+    (void)signal(SIGPIPE, SIG_IGN);
+
+    (void)setenv("TERM", DEFAULT_TERM, 0);
+    (void)setenv("LINES", DEFAULT_LINES, 0);
+    (void)setenv("COLUMNS", DEFAULT_COLUMNS, 0);
+
+    // Every session holds a handful of descriptors
+    struct rlimit lim;
+    if (getrlimit(RLIMIT_NOFILE, &lim) == 0) {
+        lim.rlim_cur = lim.rlim_max;
+        (void)setrlimit(RLIMIT_NOFILE, &lim);
+    }
+
+    FILE* null = fopen("/dev/null", "r+");
+    if (!null) { log_and_exit("Failed to open /dev/null\n"); }
+    SCREEN* layout = newterm(NULL, null, null);
+    if (!layout) {
+        log_and_exit("newterm failed for TERM=%s\n", getenv("TERM"));
+    }
+    initialise_menus();
+    set_up_input();
+    delscreen(layout);
+    (void)fclose(null);
+    preload_dialogues();
+
+    set_input_wait(wait_for_input);
+}
+
+/*!
+ * \param[in] address Either a port number, in which case the socket listens on
+ * the loopback interface, or the path of a Unix socket to create
+ *
+ * \returns A non-blocking listening socket
+ */
+int open_listener(char const* address)
+{
+    bool is_port = *address != '\0';
+    for (char const* c = address; *c; ++c) {
+        if (!isdigit((unsigned char)*c)) { is_port = false; }
+    }
+
+    int fd  = -1;
+    int err = 0;
+    if (is_port) {
+        fd      = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int one = 1;
+        (void)setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+        struct sockaddr_in addr = {
+            .sin_family      = AF_INET,
+            .sin_port        = htons((uint16_t)atoi(address)),
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+        err = bind(fd, (struct sockaddr*)&addr, sizeof addr);
+    }
+    else {
+        struct sockaddr_un addr = {.sun_family = AF_UNIX};
+        if (strlen(address) >= sizeof addr.sun_path) {
+            log_and_exit("Socket path '%s' is too long\n", address);
+        }
+        strcpy(addr.sun_path, address);
+        (void)unlink(address);
+        fd  = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        err = bind(fd, (struct sockaddr*)&addr, sizeof addr);
+    }
+
+    if (fd == -1 || err != 0 || listen(fd, LISTEN_BACKLOG) != 0) {
+        log_and_exit("Failed to listen on '%s': %s\n", address,
+                     strerror(errno));
+    }
+    set_non_blocking(fd);
+
+    return fd;
+}
+
+//! Registers the sessions for all connections passed through handoff
+static void receive_clients(int handoff)
+{
+    while (true) {
+        char byte = 0;
+        struct iovec iov = {.iov_base = &byte, .iov_len = 1};
+        union
+        {
+            struct cmsghdr align;
+            char buf[CMSG_SPACE(sizeof(int))];
+        } control;
+        struct msghdr msg = {.msg_iov        = &iov,
+                             .msg_iovlen     = 1,
+                             .msg_control    = control.buf,
+                             .msg_controllen = sizeof control.buf};
+
+        ssize_t n = recvmsg(handoff, &msg, MSG_CMSG_CLOEXEC);
+        if (n < 0 && errno == EINTR) { continue; }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) { return; }
+        if (n <= 0) { log_and_exit("The acceptor has gone away\n"); }
+
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        if (cmsg && cmsg->cmsg_type == SCM_RIGHTS) {
+            int client = -1;
+            memcpy(&client, CMSG_DATA(cmsg), sizeof client);
+            new_session(client);
+        }
+    }
+}
+
+static void add_to_loop(int fd, void const* tag)
+{
+    struct epoll_event ev = {.events = EPOLLIN, .data.ptr = (void*)tag};
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        log_and_exit("epoll_ctl failed: %s\n", strerror(errno));
+    }
+}
+
+/*!
+ * \brief Event loop of a shard
+ *
+ * \param[in] listener Socket to accept connections from, or -1
+ * \param[in] handoff Socket to receive connections from, or -1
+ * \param[in] watch Socket to accept watchers from, or -1
+ */
+static void run_loop(int listener, int handoff, int watch)
+{
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1) {
+        log_and_exit("epoll_create1 failed: %s\n", strerror(errno));
+    }
+    if (listener != -1) { add_to_loop(listener, &listener_tag); }
+    if (handoff != -1) { add_to_loop(handoff, &handoff_tag); }
+    if (watch != -1) { add_to_loop(watch, &watch_tag); }
+    watchable = watch != -1;
+
+    int const timeout = idle_timeout_s > 0 ? IDLE_SCAN_MS : -1;
+    time_t last_scan  = time(NULL);
+
+    struct epoll_event events[MAX_EVENTS];
+    while (true) {
+        int n = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout);
+        if (n == -1) {
+            if (errno == EINTR) { continue; }
+            log_and_exit("epoll_wait failed: %s\n", strerror(errno));
+        }
+
+        for (int i = 0; i < n; ++i) {
+            void* tag = events[i].data.ptr;
+            if (tag == &listener_tag) { accept_clients(listener, new_session); }
+            else if (tag == &watch_tag) {
+                accept_clients(watch, new_watcher);
+            }
+            else if (tag == &handoff_tag) {
+                receive_clients(handoff);
+            }
+            else if (*(Peer_kind*)tag == peer_watcher) {
+                handle_watcher((Watcher*)tag, events[i].events);
+            }
+            else {
+                handle_client((Session*)tag, events[i].events);
+            }
+        }
+
+        if (idle_timeout_s > 0 && time(NULL) != last_scan) {
+            hibernate_idle_sessions();
+            last_scan = time(NULL);
+        }
+    }
+}
+
+void set_idle_timeout(int seconds) { idle_timeout_s = seconds; }
+
+void set_recording_dir(char const* dir) { recording_dir = dir; }
+
+void serve(int listener, int watch)
+{
+    static Shard_stats only_shard;
+    stats = &only_shard;
+
+    run_loop(listener, -1, watch);
+}
+
+//! A worker process hosting a share of the sessions
+typedef struct Shard
+{
+    pid_t pid;
+    int cpu;
+    //! The acceptor's end of the handoff socketpair
+    int handoff;
+} Shard;
+
+//! Returns the n-th CPU this process may run on (wrapping around)
+static int nth_cpu(int n)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof set, &set) != 0 || CPU_COUNT(&set) == 0) {
+        return -1;
+    }
+
+    n %= CPU_COUNT(&set);
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set) && n-- == 0) { return cpu; }
+    }
+
+    return -1;
+}
+
+static Shard start_shard(int listener, Shard_stats* shard_stats, int cpu)
+{
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, pair) != 0) {
+        log_and_exit("socketpair failed: %s\n", strerror(errno));
+    }
+
+    pid_t pid = fork();
+    if (pid == -1) { log_and_exit("fork failed: %s\n", strerror(errno)); }
+    if (pid == 0) {
+        (void)prctl(PR_SET_PDEATHSIG, SIGTERM);
+        close(listener);
+        close(pair[0]);
+        if (cpu != -1) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            (void)sched_setaffinity(0, sizeof set, &set);
+        }
+        set_non_blocking(pair[1]);
+
+        stats = shard_stats;
+        run_loop(-1, pair[1], -1);
+    }
+    close(pair[1]);
+
+    return (Shard){.pid = pid, .cpu = cpu, .handoff = pair[0]};
+}
+
+/*!
+ * \brief Passes client to the live shard with the fewest sessions
+ *
+ * Ties are broken round robin, so that a burst of connections is spread out
+ * before the shards have registered them.
+ */
+static void hand_off(Shard* shards, Shard_stats* shard_stats, int count,
+                     int client)
+{
+    static int next = 0; //NOLINT
+
+    int best = -1;
+    for (int j = 0; j < count; ++j) {
+        int const i = (next + j) % count;
+        if (shards[i].pid == -1) { continue; }
+        if (best == -1 || atomic_load(&shard_stats[i].sessions) <
+                              atomic_load(&shard_stats[best].sessions)) {
+            best = i;
+        }
+    }
+    if (best == -1) { log_and_exit("All shards have died\n"); }
+
+    char byte = 0;
+    struct iovec iov = {.iov_base = &byte, .iov_len = 1};
+    union
+    {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(int))];
+    } control;
+    memset(&control, 0, sizeof control);
+    struct msghdr msg = {.msg_iov        = &iov,
+                         .msg_iovlen     = 1,
+                         .msg_control    = control.buf,
+                         .msg_controllen = sizeof control.buf};
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level     = SOL_SOCKET;
+    cmsg->cmsg_type      = SCM_RIGHTS;
+    cmsg->cmsg_len       = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &client, sizeof client);
+
+    next = (best + 1) % count;
+    if (sendmsg(shards[best].handoff, &msg, MSG_NOSIGNAL) == -1) {
+        log_msgf("Handing a connection to shard %d failed: %s\n", best,
+                 strerror(errno));
+    }
+    close(client);
+}
+
+static void log_shard_stats(Shard const* shards, Shard_stats* shard_stats,
+                            int count)
+{
+    for (int i = 0; i < count; ++i) {
+        unsigned long long frames = atomic_load(&shard_stats[i].frames);
+        unsigned long long total  = atomic_load(&shard_stats[i].frame_ns);
+        unsigned long long max    = atomic_load(&shard_stats[i].max_frame_ns);
+        log_msgf("shard %d (cpu %d): %d sessions (%d hibernating), %llu "
+                 "frames, mean %.3f ms, max %.3f ms\n",
+                 i, shards[i].cpu, atomic_load(&shard_stats[i].sessions),
+                 atomic_load(&shard_stats[i].hibernating),
+                 frames, frames ? (double)total / (double)frames / 1e6 : 0.0,
+                 (double)max / 1e6);
+    }
+}
+
+/*!
+ * \param[in] listener The socket to accept connections from
+ * \param[in] count The number of shards, or 0 for one per available CPU
+ */
+void serve_sharded(int listener, int count)
+{
+    if (count <= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        count = sched_getaffinity(0, sizeof set, &set) == 0 ? CPU_COUNT(&set)
+                                                            : 1;
+    }
+
+    Shard_stats* shard_stats =
+        mmap(NULL, sizeof(Shard_stats) * (size_t)count, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    Shard* shards = (Shard*)calloc((size_t)count, sizeof(Shard));
+    if (shard_stats == MAP_FAILED || !shards) {
+        log_and_exit("Failed to allocate %d shards\n", count);
+    }
+    for (int i = 0; i < count; ++i) {
+        shards[i] = start_shard(listener, &shard_stats[i], nth_cpu(i));
+    }
+
+    // Accept with blocking calls, waking up for the statistics
+    int flags = fcntl(listener, F_GETFL);
+    (void)fcntl(listener, F_SETFL, flags & ~O_NONBLOCK);
+    struct timeval interval = {.tv_sec = STATS_INTERVAL_S};
+    (void)setsockopt(listener, SOL_SOCKET, SO_RCVTIMEO, &interval,
+                     sizeof interval);
+
+    time_t last_log = time(NULL);
+    while (true) {
+        int client = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+        if (client >= 0) { hand_off(shards, shard_stats, count, client); }
+        else if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK &&
+                 errno != ECONNABORTED) {
+            log_and_exit("accept failed: %s\n", strerror(errno));
+        }
+
+        pid_t dead = 0;
+        while ((dead = waitpid(-1, NULL, WNOHANG)) > 0) {
+            for (int i = 0; i < count; ++i) {
+                if (shards[i].pid != dead) { continue; }
+                log_msgf("Shard %d died\n", i);
+                shards[i].pid = -1;
+                close(shards[i].handoff);
+            }
+        }
+
+        if (time(NULL) - last_log >= STATS_INTERVAL_S) {
+            log_shard_stats(shards, shard_stats, count);
+            last_log = time(NULL);
+        }
+    }
+}
+
+//! Socket played on by a forked session
+static int forked_client = -1; //NOLINT
+
+//! \ref Input_wait of a forked session, ending it when the client hangs up
+static void wait_for_socket(void)
+{
+    struct pollfd p = {.fd = forked_client, .events = POLLIN};
+    while (poll(&p, 1, -1) == -1 && errno == EINTR) {}
+
+    char byte = 0;
+    if (recv(forked_client, &byte, 1, MSG_PEEK) <= 0) { _exit(0); }
+}
+
+//! Plays a session on client in a freshly forked process
+static void play_forked(int client)
+{
+    forked_client = client;
+    FILE* in      = fdopen(client, "r");
+    FILE* out     = fdopen(dup(client), "w");
+    SCREEN* screen = in && out ? newterm(NULL, out, in) : NULL;
+    if (!screen) { _exit(1); }
+    (void)configure_screen();
+    set_escdelay(ESC_DELAY_MS);
+    set_input_wait(wait_for_socket);
+
+    Context* ctx = new_game_context();
+    run_game(ctx);
+    endwin();
+    _exit(0);
+}
+
+/*!
+ * \brief Hosts every connection accepted on listener in a process of its own
+ *
+ * Everything \ref init_server loaded stays shared between the processes, so a
+ * session starts without loading anything.
+ */
+void serve_prefork(int listener)
+{
+    // Children are reaped by the kernel
+    struct sigaction sa = {.sa_handler = SIG_DFL, .sa_flags = SA_NOCLDWAIT};
+    (void)sigemptyset(&sa.sa_mask);
+    (void)sigaction(SIGCHLD, &sa, NULL);
+
+    int flags = fcntl(listener, F_GETFL);
+    (void)fcntl(listener, F_SETFL, flags & ~O_NONBLOCK);
+
+    while (true) {
+        int client = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+        if (client == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) { continue; }
+            log_and_exit("accept failed: %s\n", strerror(errno));
+        }
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(listener);
+            play_forked(client);
+        }
+        if (pid == -1) { log_msgf("fork failed: %s\n", strerror(errno)); }
+        close(client);
+    }
+}
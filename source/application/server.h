@@ -0,0 +1,38 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+/*! \file server.h
+ * \brief Hosting many game sessions in a single process
+ *
+ * Instead of running one process per player behind a PTY, a server accepts
+ * connections on a local socket and plays a separate game session on each of
+ * them, all multiplexed from one epoll loop. See \ref server.c for details.
+ */
+
+//! Prepares the process for hosting sessions, to be called once before \ref
+//! serve
+void init_server(void);
+
+//! Opens a listening socket on a local TCP port (if address is a number) or a
+//! Unix socket path
+int open_listener(char const* address);
+
+//! Sets the seconds a session may idle before it is hibernated (0 disables)
+void set_idle_timeout(int seconds);
+
+//! Records every session of \ref serve and \ref serve_sharded into an
+//! asciicast file in dir, named after the process and the session number
+void set_recording_dir(char const* dir);
+
+//! Hosts a game session for every connection accepted on listener, and lets
+//! the connections accepted on watch (unless it is -1) follow those sessions
+void serve(int listener, int watch);
+
+//! Hosts every connection in a process of its own, forked from this one
+void serve_prefork(int listener);
+
+//! Like \ref serve, but spreads the sessions over count pinned worker
+//! processes (one per CPU if count is 0)
+void serve_sharded(int listener, int count);
+
+#endif
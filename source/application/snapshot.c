@@ -0,0 +1,185 @@
+/*!
+ * \file snapshot.c
+ * \brief Implementation file for \ref snapshot.h
+ *
+ * A snapshot is a header followed by one record per command on the stack,
+ * from the bottom up, and a last record for the checkpoint. Persistent
+ * commands are never freed, so their address is enough. Every other command
+ * is created by one of a handful of constructors, and is stored by value.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "accounting.h"
+#include "games/sudoku.h"
+#include "menu.h"
+#include "snapshot.h"
+#include "state.h"
+
+#define SNAPSHOT_MAGIC "GSN1"
+
+enum
+{
+    SNAPSHOT_MAGIC_LEN = 4,
+    SUDOKU_CELLS       = 81
+};
+
+//! The kinds of records in a snapshot
+enum Record_kind
+{
+    //! A persistent command, stored by address
+    rec_static,
+    //! A command made by \ref new_command
+    rec_command,
+    //! A \ref Menu_command
+    rec_menu,
+    //! A \ref Sudoku_progress
+    rec_sudoku
+};
+
+static bool write_record(FILE* f, Command const* c, bool by_value)
+{
+    uint8_t kind = rec_command;
+    if (c->persistent && !by_value) { kind = rec_static; }
+    else if (c->execute == show_menu) {
+        kind = rec_menu;
+    }
+    else if (c->execute == resume_sudoku) {
+        kind = rec_sudoku;
+    }
+
+    bool ok = fwrite(&kind, sizeof kind, 1, f) == 1;
+    switch (kind) {
+        case rec_static: ok = ok && fwrite(&c, sizeof c, 1, f) == 1; break;
+        case rec_command:
+            ok = ok && fwrite(&c->execute, sizeof c->execute, 1, f) == 1;
+            break;
+        case rec_menu: {
+            Menu_command const* mc = (Menu_command const*)c;
+            int32_t highlight      = mc->highlight;
+            ok = ok && fwrite(&mc->menu, sizeof mc->menu, 1, f) == 1 &&
+                 fwrite(&highlight, sizeof highlight, 1, f) == 1;
+        } break;
+        case rec_sudoku: {
+            Sudoku_progress const* p = (Sudoku_progress const*)c;
+            uint8_t cells[SUDOKU_CELLS + 2];
+            for (int i = 0; i < SUDOKU_CELLS; ++i) {
+                cells[i] = (uint8_t)p->board[i / 9][i % 9];
+            }
+            cells[SUDOKU_CELLS]     = (uint8_t)p->y;
+            cells[SUDOKU_CELLS + 1] = (uint8_t)p->x;
+            ok = ok && fwrite(&p->puzzle, sizeof p->puzzle, 1, f) == 1 &&
+                 fwrite(cells, sizeof cells, 1, f) == 1;
+        } break;
+        default:;
+    }
+
+    return ok;
+}
+
+//! Reads a record, returning NULL on failure
+static Command* read_record(FILE* f)
+{
+    uint8_t kind = 0;
+    if (fread(&kind, sizeof kind, 1, f) != 1) { return NULL; }
+
+    switch (kind) {
+        case rec_static: {
+            Command* c = NULL;
+            return fread(&c, sizeof c, 1, f) == 1 ? c : NULL;
+        }
+        case rec_command: {
+            Command* (*execute)(void*, Context*) = NULL;
+            if (fread(&execute, sizeof execute, 1, f) != 1) { return NULL; }
+            return new_command(execute, false);
+        }
+        case rec_menu: {
+            Menu const* menu  = NULL;
+            int32_t highlight = 0;
+            if (fread(&menu, sizeof menu, 1, f) != 1 ||
+                fread(&highlight, sizeof highlight, 1, f) != 1) {
+                return NULL;
+            }
+            return new_menu_command(menu, highlight);
+        }
+        case rec_sudoku: {
+            Sudoku_progress* p =
+                (Sudoku_progress*)tracked_calloc(sub_application, 1, sizeof *p);
+            uint8_t cells[SUDOKU_CELLS + 2];
+            if (fread(&p->puzzle, sizeof p->puzzle, 1, f) != 1 ||
+                fread(cells, sizeof cells, 1, f) != 1) {
+                tracked_free(p);
+                return NULL;
+            }
+            p->command = (Command){.execute = resume_sudoku, .persistent = false};
+            for (int i = 0; i < SUDOKU_CELLS; ++i) {
+                p->board[i / 9][i % 9] = cells[i];
+            }
+            p->y = cells[SUDOKU_CELLS];
+            p->x = cells[SUDOKU_CELLS + 1];
+            return (Command*)p;
+        }
+        default: return NULL;
+    }
+}
+
+bool write_snapshot(FILE* file, Context const* ctx)
+{
+    if (!ctx->checkpoint) { return false; }
+
+    struct Player player     = get_player(ctx);
+    struct Settings settings = get_settings(ctx);
+    int32_t size             = command_stack_size(ctx);
+
+    bool ok = fwrite(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LEN, 1, file) == 1 &&
+              fwrite(&player, sizeof player, 1, file) == 1 &&
+              fwrite(&settings, sizeof settings, 1, file) == 1 &&
+              fwrite(&size, sizeof size, 1, file) == 1;
+    for (int i = size - 1; ok && i >= 0; --i) {
+        ok = write_record(file, command_stack_peek(ctx, i), false);
+    }
+    ok = ok && write_record(file, ctx->checkpoint, true);
+
+    return ok && fflush(file) == 0;
+}
+
+/*!
+ * The checkpoint of the snapshot becomes the \ref Context::checkpoint of the
+ * returned context. It is not persistent, so passing it to \ref resume_game
+ * hands over its ownership.
+ */
+Context* read_snapshot(FILE* file)
+{
+    char magic[SNAPSHOT_MAGIC_LEN];
+    struct Player player;
+    struct Settings settings;
+    int32_t size = 0;
+    if (fread(magic, sizeof magic, 1, file) != 1 ||
+        memcmp(magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LEN) != 0 ||
+        fread(&player, sizeof player, 1, file) != 1 ||
+        fread(&settings, sizeof settings, 1, file) != 1 ||
+        fread(&size, sizeof size, 1, file) != 1) {
+        return NULL;
+    }
+
+    Context* ctx = new_game_context();
+    restore_player(ctx, player);
+    restore_settings(ctx, settings);
+    for (int i = 0; i < size; ++i) {
+        Command* c = read_record(file);
+        if (!c) {
+            free_game_context(ctx);
+            return NULL;
+        }
+        push_command(ctx, c);
+    }
+
+    ctx->checkpoint = read_record(file);
+    if (!ctx->checkpoint) {
+        free_game_context(ctx);
+        return NULL;
+    }
+
+    return ctx;
+}
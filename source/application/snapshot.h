@@ -0,0 +1,24 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+/*! \file snapshot.h
+ * \brief Saving a waiting game session to a file and restoring it
+ *
+ * A snapshot holds the players progress and settings, the command stack and
+ * the \ref Context::checkpoint the session is waiting at. Commands and menus
+ * are stored by address, so a snapshot can only be read by the process that
+ * wrote it (or by one forked from it).
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "base.h"
+
+//! Writes the session ctx, which has to be waiting at a checkpoint, to file
+bool write_snapshot(FILE* file, Context const* ctx);
+
+//! Recreates a session from a snapshot, NULL on failure
+Context* read_snapshot(FILE* file);
+
+#endif
@@ -7,14 +7,18 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "accounting.h"
+#include "art.h"
 #include "base.h"
 #include "games/sudoku.h"
+#include "io/keys.h"
 #include "io/logging.h"
 #include "io/utf8.h"
 #include "menu.h"
 #include "menu_constants.h"
 #include "start.h"
 #include "state.h"
+#include "window_pool.h"
 
 #define GET_AND_PRINT_DIA(file, width)                                         \
     {                                                                          \
@@ -41,16 +45,13 @@ static void perform_atexit(void)
     close_log_stream();
 }
 
-//! \brief Sets the locale, initialises ncurses with common defaults, and
-//! registers a function to be called on exit
-static void ncurses_set_up(void)
+/*!
+ * \brief Applies the common defaults of the game to the current ncurses screen
+ *
+ * \returns false if the terminal doesn't support an invisible cursor
+ */
+bool configure_screen(void)
 {
-    const char* locale = setlocale(LC_ALL, "");
-    if (locale == NULL) {
-        fprintf(stderr, "Error setting locale, aborting.../\n"); //NOLINT
-        exit(1);
-    }
-    initscr();
     start_color();
     init_color_pairs();
     clear();
@@ -61,6 +62,23 @@ static void ncurses_set_up(void)
     //Add this?
     // raw();
     keypad(stdscr, TRUE);
+    // UTF-8 input needs all 8 bits, which ncurses only passes on by itself
+    // when reading from an 8-bit tty, not e.g. from the pipes of the server
+    meta(stdscr, true);
+
+    return curs_set(0) != ERR;
+}
+
+//! \brief Sets the locale, initialises ncurses with common defaults, and
+//! registers a function to be called on exit
+static void ncurses_set_up(void)
+{
+    const char* locale = setlocale(LC_ALL, "");
+    if (locale == NULL) {
+        fprintf(stderr, "Error setting locale, aborting.../\n"); //NOLINT
+        exit(1);
+    }
+    initscr();
 
     int err = atexit(perform_atexit);
     if (err != 0) {
@@ -71,8 +89,7 @@ static void ncurses_set_up(void)
         endwin();
         exit(1);
     }
-    err = curs_set(0);
-    if (err == ERR) {
+    if (!configure_screen()) {
         fprintf(stderr, //NOLINT
                 "Terminal doesn't support invisible cursor, support to be "
                 "added.\n Aborting...\n");
@@ -80,61 +97,121 @@ static void ncurses_set_up(void)
     }
 }
 
+//! Shows how to play over whatever is on screen, see \ref set_global_key
+static bool show_controls(Input_event const* _ __attribute__((unused)))
+{
+    print_diastr("Arrow keys or WASD move, Enter selects and Esc shows this.");
+    return true;
+}
+
+/*!
+ * Binds the keys listed in the file named by the environment variable
+ * NCURSESGAME_KEYS, if it is set, and has Esc show the controls anywhere.
+ * Needs an ncurses screen to look the names of keys up.
+ */
+void set_up_input(void)
+{
+    char const* bindings = getenv("NCURSESGAME_KEYS");
+    if (bindings) { (void)load_key_bindings(bindings); }
+    set_global_key(act_escape, show_controls);
+}
+
 void init_game(void)
 {
     ncurses_set_up();
+    set_up_input();
     initialise_menus();
     set_log_output(stderr);
 }
 
 Command* start_game(void) { return new_command(show_opening, false); }
 
-Command* show_opening(void* _ __attribute__((unused)))
+/*!
+ * \brief Plays a game session from the opening until the player exits
+ *
+ * \param[in,out] ctx The context of the session, see \ref new_game_context
+ */
+void run_game(Context* ctx) { resume_game(ctx, start_game()); }
+
+/*!
+ * \param[in,out] ctx The context of the session
+ * \param[in] first The command to execute first, e.g. a \ref
+ * Context::checkpoint of a restored session
+ */
+void resume_game(Context* ctx, Command* first)
+{
+    Command* curr = first;
+    while (curr->execute) {
+        ctx->running = curr;
+        Command* old = curr;
+        curr         = curr->execute(curr, ctx);
+        if (!old->persistent) { tracked_free(old); }
+    }
+    // The command ending the game may have been popped of the stack
+    if (!curr->persistent) { tracked_free(curr); }
+    ctx->running = NULL;
+}
+
+Command* show_opening(void* _ __attribute__((unused)),
+                      Context* __ __attribute__((unused)))
 {
     GET_AND_PRINT_DIA("opening.txt", COLS / 3);
     return new_menu_command(start_menu, 0);
 }
 
-static Command* show_options_execute(void* _ __attribute__((unused)))
+static Command* show_options_execute(void* _ __attribute__((unused)),
+                                     Context* ctx)
 {
-    push_command(new_menu_command(start_menu, 1));
-    Command* op = print_menu(options_menu, 0);
+    push_command(ctx, new_menu_command(start_menu, 1));
+    Command* op = print_menu(ctx, options_menu, 0);
     return op;
 }
 
 Command const show_options = {.execute    = show_options_execute,
                               .persistent = true};
 
-static Command* show_glade_execute(void* _ __attribute__((unused)))
+static Command* show_glade_execute(void* _ __attribute__((unused)),
+                                   Context* ctx)
 {
-    if (!player_visited_glade_val()) {
+    if (!player_visited_glade_val(ctx)) {
         GET_AND_PRINT_DIA("intro.txt", COLS / 2);
-        player_visited_glade_set();
+        player_visited_glade_set(ctx);
     }
-    Command* op = print_menu(glade_menu, 0);
+    Command* op = print_menu(ctx, glade_menu, 0);
 
     return op;
 }
 
 Command const show_glade = {.execute = show_glade_execute, .persistent = true};
 
-static Command* show_well_execute(void* _ __attribute__((unused)))
+static Command* show_well_execute(void* _ __attribute__((unused)), Context* ctx)
 {
     Command* res = new_command(show_glade_execute, false);
-    push_command(res);
-    if (player_visited_well_val()) {
+    push_command(ctx, res);
+    if (player_visited_well_val(ctx)) {
         GET_AND_PRINT_DIA("well.txt", COLS / 2);
-        player_visited_well_set();
+        player_visited_well_set(ctx);
     }
 
-    Command* op = print_menu(well_menu, 0);
+    Command* op = print_menu(ctx, well_menu, 0);
 
     return op;
 }
 
 Command const show_well = {.execute = show_well_execute, .persistent = true};
 
-// static Command* show_cabin_execute(void* _ __attribute__((unused)))
+//! Shows the well menu again, the way back having already been pushed
+static Command* return_to_well_execute(void* _ __attribute__((unused)),
+                                       Context* ctx)
+{
+    return print_menu(ctx, well_menu, 0);
+}
+
+Command const return_to_well = {.execute    = return_to_well_execute,
+                                .persistent = true};
+
+// static Command* show_cabin_execute(void* _ __attribute__((unused)),
+//                                    Context* ctx)
 // {
 //     if (!player_visited_cabin_val()) {
 //         player_visited_cabin_set();
@@ -142,18 +219,8 @@ Command const show_well = {.execute = show_well_execute, .persistent = true};
 //     }
 // }
 
-static Banner gudrun_banner(void)
-{
-    static bool first_call = true;
-    static Banner res      = {0};
-
-    if (first_call) {
-        first_call = false;
-        res = make_banner(gudrun_art, sizeof(gudrun_art) / sizeof(char*));
-    }
-
-    return res;
-}
+//! The banner of the gudrun menu, measured when the game was built
+static Banner gudrun_banner(void) { return gudrun_menu->banner; }
 
 Sudoku_command const gertrud_sudoku = {
     .command = {.execute = paint_sudoku, .persistent = true},
@@ -173,25 +240,25 @@ Sudoku_command const gertrud_sudoku = {
 static Command* knock_freaky(void)
 {
     GET_AND_PRINT_DIA("freaky.txt", COLS / 3);
-    int h = sizeof(freaky_apple_art) / sizeof(freaky_apple_art[0]);
-    int w = utf8_strlen(freaky_apple_art[0]);
-    WINDOW* freaky_apple_win = newwin(h, w, 0, 0);
+    Banner const apple = FREAKY_APPLE_BANNER();
+    WINDOW* freaky_apple_win =
+        take_window(apple.dim.height, apple.dim.width, 0, 0);
     intrflush(freaky_apple_win, false);
     keypad(freaky_apple_win, true);
 
-    for (int i = 0; i < h; ++i) {
-        mvwaddstr(freaky_apple_win, i, 0, freaky_apple_art[i]);
-    }
-    wrefresh(freaky_apple_win);
-    get_input_char((Input){.win = freaky_apple_win, .tag = tag_win});
+    paint_banner(freaky_apple_win, apple, 0, 0);
+    stage_window(freaky_apple_win);
+    // The apple stays in the corner whatever size the screen is
+    while (get_input_char((Input){.win = freaky_apple_win, .tag = tag_win}) ==
+           KEY_RESIZE) {}
     win_cleanup(freaky_apple_win);
 
     return (Command*)&show_cabin;
 }
 
-Command* go_to_cabin_execute(void* _ __attribute__((unused)))
+Command* go_to_cabin_execute(void* _ __attribute__((unused)), Context* ctx)
 {
-    if (player_has_forest_map_val()) { return (Command*)&show_gudrun; }
+    if (player_has_forest_map_val(ctx)) { return (Command*)&show_gudrun; }
     else {
         return (Command*)&show_cabin;
     }
@@ -200,20 +267,20 @@ Command* go_to_cabin_execute(void* _ __attribute__((unused)))
 Command const go_to_cabin = {.execute    = go_to_cabin_execute,
                              .persistent = true};
 
-Command* gudruns_mission(void* _ __attribute__((unused)))
+Command* gudruns_mission(void* _ __attribute__((unused)), Context* ctx)
 {
     GET_AND_PRINT_DIA_BANNER("gudruns_mission.txt", gudrun_banner(), COLS / 3);
 
     print_diastr("You have received the forest map!");
-    player_has_forest_map_set();
+    player_has_forest_map_set(ctx);
 
     return (Command*)&go_to_cabin;
 }
 
-static Command* knock_execute(void* _ __attribute__((unused)))
+static Command* knock_execute(void* _ __attribute__((unused)), Context* ctx)
 {
-    static bool has_knocked = false;
-    if (!has_knocked) {
+    if (!player_has_knocked_val(ctx)) {
+        player_has_knocked_set(ctx);
         print_diastr("You approach the door and knock.");
         print_diastr(".");
         print_diastr("..");
@@ -224,15 +291,15 @@ static Command* knock_execute(void* _ __attribute__((unused)))
     print_diastr("The door seems to be locked.");
 
 
-    if (!player_has_key_val()) { return (Command*)&show_cabin; }
+    if (!player_has_key_val(ctx)) { return (Command*)&show_cabin; }
 
     print_diastr("Use key?");
-    int res = quick_print_menu(0, 2, "Yes", "No");
+    int res = quick_print_menu(ctx, 0, 2, "Yes", "No");
     if (res == 0) {
-        if (is_katte_mode()) { return knock_freaky(); }
+        if (is_katte_mode(ctx)) { return knock_freaky(); }
         GET_AND_PRINT_DIA_BANNER("meeting_gudrun.txt", gudrun_banner(),
                                  COLS / 4);
-        push_command(new_command(gudruns_mission, false));
+        push_command(ctx, new_command(gudruns_mission, false));
         return (Command*)&gertrud_sudoku;
     }
     else if (res == 1) {
@@ -244,10 +311,11 @@ static Command* knock_execute(void* _ __attribute__((unused)))
 
 Command const knock = {.execute = knock_execute, .persistent = true};
 
-Command* switch_katte_mode_execute(void* _ __attribute__((unused)))
+Command* switch_katte_mode_execute(void* _ __attribute__((unused)),
+                                   Context* ctx)
 {
-    set_katte_mode(!is_katte_mode());
-    bool katte_mode = is_katte_mode();
+    set_katte_mode(ctx, !is_katte_mode(ctx));
+    bool katte_mode = is_katte_mode(ctx);
 
     char const* str =
         katte_mode ? "Katte mode enabled!" : "Katte mode disabled!";
@@ -259,28 +327,13 @@ Command* switch_katte_mode_execute(void* _ __attribute__((unused)))
 Command const switch_katte_mode = {.execute    = switch_katte_mode_execute,
                                    .persistent = true};
 
-// clang-format off
-    char const* const bucket[] = {
-        " ───┴───",
-        "/_______\\",
-        "\\\\      /",
-        " \\\\    /",
-        "  -----",
-    };
-// clang-format on
-
 static void wpaint_bucket(WINDOW* win, int const y)
 {
     int const max_x = getmaxx(win);
 
-    Banner b = make_banner(bucket, sizeof(bucket) / sizeof(char*));
-
-    int const x = (max_x - b.dim.width) / 2;
-    for (int i = 0; i < b.dim.height; ++i) {
-        mvwaddstr(win, y + i, x, bucket[i]);
-    }
+    Banner const b = BUCKET_BANNER();
 
-    wrefresh(win);
+    paint_banner(win, b, y, (max_x - b.dim.width) / 2);
 }
 
 static void wpaint_rope(WINDOW* win, int count, int piece_len, int bucket_width)
@@ -294,42 +347,47 @@ static void wpaint_rope(WINDOW* win, int count, int piece_len, int bucket_width)
     }
 }
 
-static int bucket_iteration(WINDOW* win, int count, int piece_len,
-                            Dim bucket_dim)
+static int bucket_iteration(Context* ctx, WINDOW* win, int count,
+                            int piece_len, Dim bucket_dim)
 {
     werase(win);
     wpaint_rope(win, count, piece_len, bucket_dim.width);
     wpaint_bucket(win, count * piece_len);
-    wrefresh(win);
-
-    int ch = wgetch(win);
-    switch (ch) {
-        case KEY_UP:
-        case 'w':
-        case 'W'     : --count; break;
-        case KEY_DOWN:
-        case 's'     :
-        case 'S'     : {
+    stage_window(win);
+
+    switch (read_input(ctx, win).action) {
+        case act_up  : --count; break;
+        case act_down: {
             int total_height = count * piece_len + bucket_dim.height;
             if (total_height + piece_len <= LINES) { ++count; }
         } break;
+        case act_resize: {
+            // The rope is shortened until the bucket fits on screen again
+            move_window(win, LINES, bucket_dim.width, 0,
+                        COLS / 2 - bucket_dim.width / 2);
+            while (count > 1 && count * piece_len + bucket_dim.height > LINES) {
+                --count;
+            }
+        } break;
         default:;
     }
 
     return count;
 }
 
-static Command* well_raise_bucket_execute(void* _ __attribute__((unused)))
+static Command* well_raise_bucket_execute(void* _ __attribute__((unused)),
+                                          Context* ctx)
 {
-    if (player_has_key_val()) {
+    if (player_has_key_val(ctx)) {
         print_diastr("You've already got the key!");
-        return (Command*)&show_well;
+        return (Command*)&return_to_well;
     }
-    Banner b = make_banner(bucket, sizeof(bucket) / sizeof(char*));
+    Banner const b = BUCKET_BANNER();
 
     int const mid_x = COLS / 2;
     // Make centered window with bucket_width
-    WINDOW* bucket_win = newwin(LINES, b.dim.width, 0, mid_x - b.dim.width / 2);
+    WINDOW* bucket_win =
+        take_window(LINES, b.dim.width, 0, mid_x - b.dim.width / 2);
     intrflush(bucket_win, false);
     keypad(bucket_win, true);
 
@@ -340,20 +398,18 @@ static Command* well_raise_bucket_execute(void* _ __attribute__((unused)))
 
     assert(count > 0);
     while (count > 0) {
-        count = bucket_iteration(bucket_win, count, piece_len, b.dim);
+        count = bucket_iteration(ctx, bucket_win, count, piece_len, b.dim);
     }
 
-    werase(bucket_win);
-    wrefresh(bucket_win);
-    delwin(bucket_win);
+    release_window(bucket_win);
 
     print_diastr("There's an old rusty key at the bottom of the bucket.");
     print_diastr("Grab it?");
 
-    int res = quick_print_menu(COLS / 8, 2, "Yes", "No"); //NOLINT(*magic*)
-    if (res == 0) { player_has_key_set(); }
+    int res = quick_print_menu(ctx, COLS / 8, 2, "Yes", "No"); //NOLINT(*magic*)
+    if (res == 0) { player_has_key_set(ctx); }
 
-    return (Command*)&show_well;
+    return (Command*)&return_to_well;
 }
 
 Command const well_raise_bucket_command = {.execute = well_raise_bucket_execute,
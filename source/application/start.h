@@ -1,17 +1,32 @@
 #ifndef START_H
 #define START_H
 
+#include <stdbool.h>
+
 #include "base.h"
 
 void init_game(void);
 
+//! Loads the key bindings of the player and sets the global keys up
+void set_up_input(void);
+
+//! Applies the common defaults of the game to the current ncurses screen
+bool configure_screen(void);
+
 Command* start_game(void);
 
-Command* show_opening(void*);
+//! Plays a game session until the player exits
+void run_game(Context* ctx);
+
+//! Plays a game session from first until the player exits
+void resume_game(Context* ctx, Command* first);
+
+Command* show_opening(void*, Context*);
 
 extern Command const show_glade;
 
 extern Command const show_well;
+extern Command const return_to_well;
 
 extern Command const well_raise_bucket_command;
 
@@ -1,43 +1,91 @@
 #include <stdbool.h>
 
-struct Player
+#include "accounting.h"
+#include "base.h"
+#include "state.h"
+
+#define PLAYER(ctx)   (((Game_context*)(ctx))->player)
+#define SETTINGS(ctx) (((Game_context*)(ctx))->settings)
+
+Context* new_game_context(void)
+{
+    Game_context* res =
+        (Game_context*)tracked_calloc(sub_application, 1, sizeof(Game_context));
+
+    return (Context*)res;
+}
+
+void free_game_context(Context* ctx)
+{
+    clear_command_stack(ctx);
+    tracked_free(ctx);
+}
+
+bool is_katte_mode(Context const* ctx)
+{
+    return SETTINGS(ctx).katte_mode_enabled;
+}
+
+void set_katte_mode(Context* ctx, bool enable)
 {
-    bool has_visited_glade;
-    bool has_visited_cabin;
-    bool has_visited_well;
-    bool has_key;
-    bool has_forest_map;
-};
+    SETTINGS(ctx).katte_mode_enabled = enable;
+}
 
-static struct Player player = {0}; //NOLINT
+bool player_visited_glade_val(Context const* ctx)
+{
+    return PLAYER(ctx).has_visited_glade;
+}
 
-struct Settings
+void player_visited_glade_set(Context* ctx)
 {
-    bool katte_mode_enabled;
-};
+    PLAYER(ctx).has_visited_glade = true;
+}
 
-static struct Settings settings = {.katte_mode_enabled = false}; //NOLINT
+bool player_visited_cabin_val(Context const* ctx)
+{
+    return PLAYER(ctx).has_visited_cabin;
+}
 
-bool is_katte_mode(void) { return settings.katte_mode_enabled; }
+void player_visited_cabin_set(Context* ctx)
+{
+    PLAYER(ctx).has_visited_cabin = true;
+}
 
-void set_katte_mode(bool enable) { settings.katte_mode_enabled = enable; }
+bool player_visited_well_val(Context const* ctx)
+{
+    return PLAYER(ctx).has_visited_well;
+}
 
-bool player_visited_glade_val(void) { return player.has_visited_glade; }
+void player_visited_well_set(Context* ctx)
+{
+    PLAYER(ctx).has_visited_well = true;
+}
 
-void player_visited_glade_set(void) { player.has_visited_glade = true; }
+bool player_has_knocked_val(Context const* ctx)
+{
+    return PLAYER(ctx).has_knocked;
+}
+
+void player_has_knocked_set(Context* ctx) { PLAYER(ctx).has_knocked = true; }
 
-bool player_visited_cabin_val(void) { return player.has_visited_cabin; }
+bool player_has_forest_map_val(Context const* ctx)
+{
+    return PLAYER(ctx).has_forest_map;
+}
 
-void player_visited_cabin_set(void) { player.has_visited_cabin = true; }
+void player_has_forest_map_set(Context* ctx)
+{
+    PLAYER(ctx).has_forest_map = true;
+}
 
-bool player_visited_well_val(void) { return player.has_visited_well; }
+bool player_has_key_val(Context const* ctx) { return PLAYER(ctx).has_key; }
 
-void player_visited_well_set(void) { player.has_visited_well = true; }
+void player_has_key_set(Context* ctx) { PLAYER(ctx).has_key = true; }
 
-bool player_has_forest_map_val(void) { return player.has_forest_map; }
+struct Player get_player(Context const* ctx) { return PLAYER(ctx); }
 
-void player_has_forest_map_set(void) { player.has_forest_map = true; }
+void restore_player(Context* ctx, struct Player p) { PLAYER(ctx) = p; }
 
-bool player_has_key_val(void) { return player.has_key; }
+struct Settings get_settings(Context const* ctx) { return SETTINGS(ctx); }
 
-void player_has_key_set(void) { player.has_key = true; }
+void restore_settings(Context* ctx, struct Settings s) { SETTINGS(ctx) = s; }
@@ -2,26 +2,81 @@
 
 #include <stdbool.h>
 
-bool is_katte_mode(void);
+#include "base.h"
 
-bool set_katte_mode(bool enable);
+//! Progress the player has made through the game
+struct Player
+{
+    bool has_visited_glade;
+    bool has_visited_cabin;
+    bool has_visited_well;
+    bool has_knocked;
+    bool has_key;
+    bool has_forest_map;
+};
 
-bool player_visited_glade_val(void);
+//! Settings the player can toggle from the options menu
+struct Settings
+{
+    bool katte_mode_enabled;
+};
 
-void player_visited_glade_set(void);
+/*!
+ * \brief The \ref Context of a game session
+ *
+ * Holds the players progress and settings alongside the command stack, so that
+ * every session has its own copy.
+ */
+typedef struct Game_context
+{
+    //! Base class - see \ref Context documentation
+    Context context;
+    struct Player player;
+    struct Settings settings;
+} Game_context;
 
-bool player_visited_cabin_val(void);
+//! Creates the context of a new game session
+Context* new_game_context(void);
 
-void player_visited_cabin_set(void);
+//! Releases a context created by \ref new_game_context
+void free_game_context(Context* ctx);
 
-bool player_has_key_val(void);
+bool is_katte_mode(Context const* ctx);
 
-bool player_has_forest_map_val(void);
+void set_katte_mode(Context* ctx, bool enable);
 
-void player_has_forest_map_set(void);
+bool player_visited_glade_val(Context const* ctx);
 
-void player_has_key_set(void);
+void player_visited_glade_set(Context* ctx);
 
-bool player_visited_well_val(void);
+bool player_visited_cabin_val(Context const* ctx);
 
-void player_visited_well_set(void);
+void player_visited_cabin_set(Context* ctx);
+
+bool player_has_knocked_val(Context const* ctx);
+
+void player_has_knocked_set(Context* ctx);
+
+bool player_has_key_val(Context const* ctx);
+
+bool player_has_forest_map_val(Context const* ctx);
+
+void player_has_forest_map_set(Context* ctx);
+
+void player_has_key_set(Context* ctx);
+
+bool player_visited_well_val(Context const* ctx);
+
+void player_visited_well_set(Context* ctx);
+
+//! Returns a copy of the players progress
+struct Player get_player(Context const* ctx);
+
+//! Overwrites the players progress, e.g. when restoring a saved state
+void restore_player(Context* ctx, struct Player p);
+
+//! Returns a copy of the current settings
+struct Settings get_settings(Context const* ctx);
+
+//! Overwrites the current settings, e.g. when restoring a saved state
+void restore_settings(Context* ctx, struct Settings s);
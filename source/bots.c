@@ -0,0 +1,513 @@
+/*!
+ * \file bots.c
+ * \brief Load generator playing many scripted game sessions at once
+ *
+ * Every bot plays a route, i.e. a fixed sequence of key presses, against a
+ * server started with serve or against game processes it spawns on PTYs. After
+ * each key the bot waits for the screen to change before thinking and pressing
+ * the next one, and the time until the first byte of the response arrives is
+ * recorded as the latency of the key. A bot that has finished its route hangs
+ * up and starts over with a new session.
+ *
+ * Every interval the throughput, the latency percentiles and the resident
+ * memory of the server (the process given with -p and all its descendants, or
+ * the spawned games) are printed, and a summary is printed at the end.
+ *
+ * Routes:
+ * - quest: start menu, glade, well, bucket, cabin and a few sudoku squares
+ * - browse: moves up and down the start menu
+ *
+ * Usage: bots [-n bots] [-t think ms] [-d seconds] [-r route] [-l LINES]
+ *             [-p server pid] (<port|socket path> | -x game [args...])
+ */
+#define _GNU_SOURCE
+
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pty.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "io/logging.h"
+
+enum
+{
+    DEFAULT_BOTS     = 10,
+    DEFAULT_THINK_MS = 200,
+    DEFAULT_SECONDS  = 30,
+    DEFAULT_LINES    = 60,
+    DEFAULT_COLUMNS  = 200,
+    //! Milliseconds without a response before a key is given up on
+    TIMEOUT_MS  = 5000,
+    REPORT_MS   = 1000,
+    MAX_ROUTE   = 256,
+    MAX_EVENTS  = 64,
+    IO_CHUNK_SZ = 65536,
+    //! Height of the bucket art, see well_raise_bucket_execute
+    BUCKET_HEIGHT = 5,
+    //! Rows the bucket moves per key press
+    ROPE_PIECE = 4
+};
+
+// Keys as sent by a terminal in keypad mode
+#define ENTER "\r"
+#define UP    "\033OA"
+#define DOWN  "\033OB"
+#define RIGHT "\033OC"
+
+//! A fixed sequence of key presses
+typedef struct Route
+{
+    char const* keys[MAX_ROUTE];
+    int len;
+} Route;
+
+typedef struct Bot
+{
+    int fd;
+    //! The game process of the bot on a PTY, or -1
+    pid_t pid;
+    int step;
+    //! When the last key (or the connection) was sent, 0 if answered
+    uint64_t sent_at;
+    //! When the next key is due
+    uint64_t next_at;
+    //! Set until the first frame of the session has arrived
+    bool connecting;
+} Bot;
+
+//! Growable array of latencies in microseconds
+typedef struct Samples
+{
+    uint32_t* data;
+    size_t len;
+    size_t cap;
+} Samples;
+
+//NOLINTBEGIN
+static Route route;
+static Bot* bots            = NULL;
+static int bots_len         = DEFAULT_BOTS;
+static int think_ms         = DEFAULT_THINK_MS;
+static int lines            = DEFAULT_LINES;
+static char const* address  = NULL;
+static char** game_argv     = NULL;
+static pid_t server_pid     = -1;
+static int epoll_fd         = -1;
+static Samples interval     = {0};
+static Samples all_keys     = {0};
+static Samples first_frames = {0};
+static long keys_sent       = 0;
+static long routes_done     = 0;
+static long timeouts        = 0;
+static long failed_connects = 0;
+static long peak_rss_kb     = 0;
+//NOLINTEND
+
+static uint64_t now_us(void)
+{
+    struct timespec t;
+    (void)clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000U + (uint64_t)t.tv_nsec / 1000U;
+}
+
+static void add_sample(Samples* s, uint32_t us)
+{
+    if (s->len == s->cap) {
+        s->cap       = s->cap ? 2 * s->cap : 1024;
+        uint32_t* tmp = (uint32_t*)realloc(s->data, s->cap * sizeof(uint32_t));
+        if (!tmp) { log_and_exit("Out of memory in %s\n", __func__); }
+        s->data = tmp;
+    }
+    s->data[s->len++] = us;
+}
+
+static int cmp_u32(void const* a, void const* b)
+{
+    uint32_t x = *(uint32_t const*)a;
+    uint32_t y = *(uint32_t const*)b;
+    return (x > y) - (x < y);
+}
+
+//! Returns the p-th percentile in milliseconds, sorting s
+static double percentile(Samples* s, double p)
+{
+    if (s->len == 0) { return 0.0; }
+    qsort(s->data, s->len, sizeof(uint32_t), cmp_u32);
+    size_t i = (size_t)(p / 100.0 * (double)(s->len - 1) + 0.5);
+    return s->data[i] / 1000.0;
+}
+
+static void add_keys(char const* key, int times)
+{
+    for (int i = 0; i < times; ++i) {
+        if (route.len == MAX_ROUTE) { log_and_exit("Route too long\n"); }
+        route.keys[route.len++] = key;
+    }
+}
+
+//! Key presses through the main quest, for a screen of height lines
+static void build_quest(void)
+{
+    add_keys(ENTER, 2); // Opening dialogue
+    add_keys(ENTER, 1); // Play
+    add_keys(ENTER, 4); // Intro dialogue
+    add_keys(DOWN, 1);
+    add_keys(ENTER, 1); // Well
+    add_keys(ENTER, 1); // Raise bucket
+    add_keys("w", (lines - BUCKET_HEIGHT) / ROPE_PIECE);
+    add_keys(ENTER, 2); // The key and "Grab it?"
+    add_keys(ENTER, 1); // Yes
+    add_keys(DOWN, 1);
+    add_keys(ENTER, 1); // Back
+    add_keys(ENTER, 1); // Cabin
+    add_keys(ENTER, 1); // Knock
+    add_keys(ENTER, 6); // Knocking and the locked door
+    add_keys(ENTER, 1); // "Use key?"
+    add_keys(ENTER, 1); // Yes
+    add_keys(ENTER, 6); // Meeting Gudrun
+    for (int i = 0; i < 3; ++i) {
+        add_keys(RIGHT, 1);
+        add_keys("1", 1);
+    }
+}
+
+static void build_browse(void)
+{
+    add_keys(ENTER, 2); // Opening dialogue
+    for (int i = 0; i < 20; ++i) { //NOLINT(*magic*)
+        add_keys(DOWN, 1);
+        add_keys(UP, 1);
+    }
+}
+
+//! Starts a new session for b, returns false on failure
+static bool start_session(Bot* b)
+{
+    b->pid = -1;
+    if (game_argv) {
+        struct winsize ws = {.ws_row = (unsigned short)lines,
+                             .ws_col = DEFAULT_COLUMNS};
+        b->pid = forkpty(&b->fd, NULL, NULL, &ws);
+        if (b->pid == -1) { return false; }
+        if (b->pid == 0) {
+            (void)setenv("TERM", "xterm-256color", 1);
+            execvp(game_argv[0], game_argv);
+            _exit(127); //NOLINT(*magic*)
+        }
+    }
+    else {
+        bool is_port = isdigit((unsigned char)address[0]);
+        b->fd = socket(is_port ? AF_INET : AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC,
+                       0);
+        int err = -1;
+        if (is_port) {
+            struct sockaddr_in addr = {
+                .sin_family      = AF_INET,
+                .sin_port        = htons((uint16_t)atoi(address)),
+                .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+            err = connect(b->fd, (struct sockaddr*)&addr, sizeof addr);
+        }
+        else {
+            struct sockaddr_un addr = {.sun_family = AF_UNIX};
+            strncpy(addr.sun_path, address, sizeof addr.sun_path - 1);
+            err = connect(b->fd, (struct sockaddr*)&addr, sizeof addr);
+        }
+        if (err != 0) {
+            close(b->fd);
+            return false;
+        }
+    }
+
+    (void)fcntl(b->fd, F_SETFL, fcntl(b->fd, F_GETFL) | O_NONBLOCK);
+    struct epoll_event ev = {.events = EPOLLIN, .data.ptr = b};
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, b->fd, &ev) == -1) {
+        log_and_exit("epoll_ctl failed: %s\n", strerror(errno));
+    }
+
+    b->step       = 0;
+    b->sent_at    = now_us();
+    b->next_at    = 0;
+    b->connecting = true;
+    return true;
+}
+
+static void end_session(Bot* b)
+{
+    (void)epoll_ctl(epoll_fd, EPOLL_CTL_DEL, b->fd, NULL);
+    close(b->fd);
+    if (b->pid > 0) {
+        (void)kill(b->pid, SIGTERM);
+        (void)waitpid(b->pid, NULL, 0);
+    }
+}
+
+static void restart(Bot* b)
+{
+    end_session(b);
+    while (!start_session(b)) {
+        ++failed_connects;
+        (void)usleep(100000); //NOLINT(*magic*)
+    }
+}
+
+//! A think time around think_ms, so that the bots drift apart
+static uint64_t think_us(void)
+{
+    return (uint64_t)think_ms * (500U + (uint64_t)(rand() % 1000)); //NOLINT
+}
+
+/*!
+ * \brief Reads everything the session of b has sent so far
+ *
+ * \returns Whether anything was read, the session is restarted if it ended
+ */
+static bool drain(Bot* b, bool* ended)
+{
+    char buf[IO_CHUNK_SZ];
+    ssize_t n = 0;
+    bool got  = false;
+    while ((n = read(b->fd, buf, sizeof buf)) > 0) { got = true; }
+
+    *ended = n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK);
+    if (*ended) { restart(b); }
+
+    return got;
+}
+
+static void on_readable(Bot* b)
+{
+    bool ended = false;
+    bool got   = drain(b, &ended);
+    if (ended || !got || b->sent_at == 0) { return; }
+
+    uint64_t const now = now_us();
+    uint32_t const us  = (uint32_t)(now - b->sent_at);
+    if (b->connecting) { add_sample(&first_frames, us); }
+    else {
+        add_sample(&interval, us);
+        add_sample(&all_keys, us);
+    }
+    b->connecting = false;
+    b->sent_at    = 0;
+    b->next_at    = now + think_us();
+}
+
+//! Sends due keys and gives up on late responses, returns the next deadline
+static uint64_t tick(uint64_t now)
+{
+    uint64_t next = now + REPORT_MS * 1000U;
+    for (int i = 0; i < bots_len; ++i) {
+        Bot* b = &bots[i];
+        if (b->sent_at) {
+            if (now - b->sent_at > TIMEOUT_MS * 1000U) {
+                ++timeouts;
+                restart(b);
+            }
+            else if (b->sent_at + TIMEOUT_MS * 1000U < next) {
+                next = b->sent_at + TIMEOUT_MS * 1000U;
+            }
+            continue;
+        }
+        if (b->next_at > now) {
+            if (b->next_at < next) { next = b->next_at; }
+            continue;
+        }
+
+        if (b->step == route.len) {
+            ++routes_done;
+            restart(b);
+            continue;
+        }
+        // The tail of the previous frame is no answer to the next key
+        bool ended = false;
+        (void)drain(b, &ended);
+        if (ended) { continue; }
+
+        // Stamped first, the game may well answer before write returns
+        char const* key = route.keys[b->step++];
+        b->sent_at      = now_us();
+        if (write(b->fd, key, strlen(key)) < 0) {
+            restart(b);
+            continue;
+        }
+        ++keys_sent;
+    }
+
+    return next;
+}
+
+//! Resident memory in kB of pid and all of its descendants
+static long tree_rss_kb(pid_t pid)
+{
+    long total = 0;
+    DIR* proc  = opendir("/proc");
+    if (!proc) { return 0; }
+
+    struct dirent* e = NULL;
+    while ((e = readdir(proc))) {
+        if (!isdigit((unsigned char)e->d_name[0])) { continue; }
+        pid_t p = (pid_t)atoi(e->d_name);
+        if (p == getpid()) { continue; }
+
+        // Walk up the ancestors of p looking for pid
+        bool in_tree = false;
+        for (pid_t a = p; a > 1 && !in_tree;) {
+            if (a == pid) {
+                in_tree = true;
+                break;
+            }
+            char path[64]; //NOLINT(*magic*)
+            snprintf(path, sizeof path, "/proc/%d/stat", a);
+            FILE* f = fopen(path, "r");
+            if (!f) { break; }
+            int ppid = 0;
+            int r    = fscanf(f, "%*d (%*[^)]) %*c %d", &ppid);
+            (void)fclose(f);
+            if (r != 1) { break; }
+            a = ppid;
+        }
+        if (!in_tree) { continue; }
+
+        char path[64]; //NOLINT(*magic*)
+        snprintf(path, sizeof path, "/proc/%d/status", p);
+        FILE* f = fopen(path, "r");
+        if (!f) { continue; }
+        char line[256]; //NOLINT(*magic*)
+        while (fgets(line, sizeof line, f)) {
+            long kb = 0;
+            if (sscanf(line, "VmRSS: %ld kB", &kb) == 1) { total += kb; }
+        }
+        (void)fclose(f);
+    }
+    (void)closedir(proc);
+
+    return total;
+}
+
+static void report(double elapsed_s, double span_s)
+{
+    pid_t root  = game_argv ? getpid() : server_pid;
+    long rss_kb = root > 0 ? tree_rss_kb(root) : 0;
+    if (rss_kb > peak_rss_kb) { peak_rss_kb = rss_kb; }
+
+    printf("%6.1fs  %8.1f keys/s  p50 %7.2f  p90 %7.2f  p99 %7.2f  max %7.2f "
+           "ms  rss %6.1f MB\n",
+           elapsed_s, (double)interval.len / span_s,
+           percentile(&interval, 50),                     //NOLINT(*magic*)
+           percentile(&interval, 90),                     //NOLINT(*magic*)
+           percentile(&interval, 99),                     //NOLINT(*magic*)
+           percentile(&interval, 100), rss_kb / 1024.0); //NOLINT(*magic*)
+    fflush(stdout);
+    interval.len = 0;
+}
+
+static void usage(char const* name)
+{
+    fprintf(stderr,
+            "Usage: %s [-n bots] [-t think ms] [-d seconds] [-r quest|browse] "
+            "[-l LINES] [-p server pid] (<port|socket path> | -x game "
+            "[args...])\n",
+            name);
+    exit(1);
+}
+
+int main(int argc, char** argv)
+{
+    set_log_output(stderr);
+
+    int seconds            = DEFAULT_SECONDS;
+    char const* route_name = "quest";
+    int opt                = 0;
+    // '+' stops at the first non-option, leaving the arguments of the game
+    while ((opt = getopt(argc, argv, "+n:t:d:r:l:p:x")) != -1) {
+        switch (opt) {
+            case 'n': bots_len = atoi(optarg); break;
+            case 't': think_ms = atoi(optarg); break;
+            case 'd': seconds = atoi(optarg); break;
+            case 'r': route_name = optarg; break;
+            case 'l': lines = atoi(optarg); break;
+            case 'p': server_pid = (pid_t)atoi(optarg); break;
+            case 'x': game_argv = argv; break;
+            default : usage(argv[0]);
+        }
+    }
+    if (optind >= argc || bots_len <= 0 || lines <= BUCKET_HEIGHT) {
+        usage(argv[0]);
+    }
+    if (game_argv) { game_argv = &argv[optind]; }
+    else {
+        address = argv[optind];
+    }
+
+    if (strcmp(route_name, "quest") == 0) { build_quest(); }
+    else if (strcmp(route_name, "browse") == 0) {
+        build_browse();
+    }
+    else {
+        usage(argv[0]);
+    }
+
+    (void)signal(SIGPIPE, SIG_IGN);
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    bots     = (Bot*)calloc((size_t)bots_len, sizeof(Bot));
+    if (epoll_fd == -1 || !bots) { log_and_exit("Failed to set up bots\n"); }
+    for (int i = 0; i < bots_len; ++i) {
+        if (!start_session(&bots[i])) {
+            log_and_exit("Failed to start session %d: %s\n", i,
+                         strerror(errno));
+        }
+    }
+
+    uint64_t const start = now_us();
+    uint64_t const end   = start + (uint64_t)seconds * 1000000U;
+    uint64_t last_report = start;
+    struct epoll_event events[MAX_EVENTS];
+    while (true) {
+        uint64_t now  = now_us();
+        uint64_t next = tick(now);
+        if (now >= end) { break; }
+        if (now - last_report >= REPORT_MS * 1000U) {
+            report((double)(now - start) / 1e6,
+                   (double)(now - last_report) / 1e6);
+            last_report = now;
+        }
+
+        int timeout = next > now ? (int)((next - now + 999) / 1000) : 0;
+        int n       = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout);
+        for (int i = 0; i < n; ++i) { on_readable((Bot*)events[i].data.ptr); }
+    }
+
+    double const total_s = (double)(now_us() - start) / 1e6;
+    printf("\n%d bots, route %s (%d keys), think %d ms, %.1f s\n", bots_len,
+           route_name, route.len, think_ms, total_s);
+    printf("keys: %ld sent, %.1f/s, %ld timed out, %ld routes completed\n",
+           keys_sent, (double)keys_sent / total_s, timeouts, routes_done);
+    printf("key latency ms: p50 %.2f  p90 %.2f  p99 %.2f  p99.9 %.2f  max "
+           "%.2f\n",
+           percentile(&all_keys, 50), percentile(&all_keys, 90), //NOLINT
+           percentile(&all_keys, 99), percentile(&all_keys, 99.9), //NOLINT
+           percentile(&all_keys, 100));                           //NOLINT
+    printf("first frame ms: p50 %.2f  p99 %.2f  (%zu sessions, %ld failed "
+           "connects)\n",
+           percentile(&first_frames, 50), percentile(&first_frames, 99), //NOLINT
+           first_frames.len, failed_connects);
+    printf("peak rss: %.1f MB\n", peak_rss_kb / 1024.0);
+
+    for (int i = 0; i < bots_len; ++i) { end_session(&bots[i]); }
+
+    return 0;
+}
@@ -0,0 +1,759 @@
+/*!
+ * \file explore.c
+ * \brief Breadth-first explorer of the games scene graph
+ *
+ * Walks every reachable combination of player progress, settings and command
+ * stack contents by executing the games commands headlessly. Menu choices are
+ * made through \ref set_menu_selector rather than the keyboard, and every
+ * other prompt is answered with an endless supply of key presses.
+ *
+ * Every transition runs in a forked child so that crashes and hangs are
+ * contained, and so that the state of the game can be restored by simply
+ * pushing the recorded commands before executing. Up to one child per core
+ * runs at a time.
+ *
+ * The explorer reports states from which the game can no longer be exited,
+ * transitions that crash or hang, stacks that grow beyond a given depth and
+ * menus that are never shown.
+ *
+ * Usage: explore [-j jobs] [-d max_stack_depth]
+ */
+#include <ncurses.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdnoreturn.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "base.h"
+#include "games/sudoku.h"
+#include "io/logging.h"
+#include "menu.h"
+#include "menu_constants.h"
+#include "start.h"
+#include "state.h"
+
+enum
+{
+    //! Maximum number of stack entries stored per state
+    MAX_STACK = 32,
+    //! Maximum number of menu choices made in a single transition
+    MAX_CHOICES = 16,
+    DEFAULT_MAX_DEPTH = 8,
+    //! Seconds before a transition is considered hung
+    TIMEOUT_SEC    = 5,
+    HEADLESS_LINES = 80,
+    HEADLESS_COLS  = 200,
+    //! Number of key presses available to a transition
+    INPUT_BYTES = 4096,
+    //! Maximum number of problems printed per category
+    REPORT_LIMIT = 10,
+    LOG_LINE_LEN = 256
+};
+
+/*!
+ * \brief Process independent description of a Command
+ *
+ * Persistent commands are static and are therefore identified by their
+ * address, which stays valid across fork. Non-persistent commands are recreated
+ * from their execute function (and menu and highlight for Menu_commands).
+ */
+typedef struct Cmd_repr
+{
+    Command* (*execute)(void*, Context*);
+    Command const* ref;
+    Menu const* menu;
+    int highlight;
+} Cmd_repr;
+
+//! The state of the game in between two executed commands
+typedef struct State
+{
+    struct Player player;
+    struct Settings settings;
+    Cmd_repr curr;
+    //! The real size of the stack, only MAX_STACK entries are stored
+    int stack_sz;
+    //! The command stack, where index 0 is the top
+    Cmd_repr stack[MAX_STACK];
+} State;
+
+//! A state to execute and the menu choices to make while doing so
+typedef struct Job
+{
+    int state;
+    int prefix_len;
+    int prefix[MAX_CHOICES];
+} Job;
+
+//! Message sent from a child to the explorer
+typedef struct Record
+{
+    enum
+    {
+        rec_choice,
+        rec_state
+    } kind;
+
+    //! Index of the chosen option among the selectable ones
+    int chosen;
+    //! Number of selectable options
+    int count;
+    char const* label;
+    Menu const* menu;
+    State state;
+} Record;
+
+typedef struct Explored
+{
+    State state;
+    //! The state from which this state was first reached, -1 for the root
+    int parent;
+    int via_len;
+    //! Labels chosen on the way from parent to this state
+    char const* via[MAX_CHOICES];
+    bool leak;
+    bool can_exit;
+} Explored;
+
+typedef struct Edge
+{
+    int from;
+    int to;
+} Edge;
+
+typedef struct Problem
+{
+    int state;
+    int via_len;
+    char const* via[MAX_CHOICES];
+    char reason[LOG_LINE_LEN];
+} Problem;
+
+typedef struct Running
+{
+    pid_t pid;
+    int fd;
+    FILE* log;
+    Job job;
+} Running;
+
+//! \cond
+#define GROW(arr, len, cap)                                                    \
+    do {                                                                       \
+        if ((len) == (cap)) {                                                  \
+            (cap)     = (cap) ? 2 * (cap) : 64;                                \
+            void* tmp = realloc((arr), (size_t)(cap) * sizeof(*(arr)));        \
+            if (!tmp) { log_and_exit("Out of memory in explore\n"); }          \
+            (arr) = tmp;                                                       \
+        }                                                                      \
+    } while (0)
+//! \endcond
+
+//NOLINTBEGIN
+static Explored* states   = NULL;
+static int states_len     = 0;
+static int states_cap     = 0;
+static int* table         = NULL;
+static int table_cap      = 0;
+static Edge* edges        = NULL;
+static int edges_len      = 0;
+static int edges_cap      = 0;
+static Job* queue         = NULL;
+static int queue_head     = 0;
+static int queue_len      = 0;
+static int queue_cap      = 0;
+static Problem* problems  = NULL;
+static int problems_len   = 0;
+static int problems_cap   = 0;
+static bool* menus_seen   = NULL;
+static int exits          = 0;
+static int transitions    = 0;
+static int max_depth      = DEFAULT_MAX_DEPTH;
+
+// Only used in children
+static Context* child_ctx   = NULL;
+static Job const* child_job = NULL;
+static int child_point      = 0;
+static int child_fd         = -1;
+//NOLINTEND
+
+static bool cmd_eq(Cmd_repr a, Cmd_repr b)
+{
+    return a.execute == b.execute && a.ref == b.ref && a.menu == b.menu &&
+           a.highlight == b.highlight;
+}
+
+static int stored_stack(State const* s)
+{
+    return s->stack_sz < MAX_STACK ? s->stack_sz : MAX_STACK;
+}
+
+static bool state_eq(State const* a, State const* b)
+{
+    if (memcmp(&a->player, &b->player, sizeof a->player) != 0 ||
+        memcmp(&a->settings, &b->settings, sizeof a->settings) != 0 ||
+        a->stack_sz != b->stack_sz || !cmd_eq(a->curr, b->curr)) {
+        return false;
+    }
+    for (int i = 0; i < stored_stack(a); ++i) {
+        if (!cmd_eq(a->stack[i], b->stack[i])) { return false; }
+    }
+
+    return true;
+}
+
+//! FNV-1a over a range of bytes, continuing from h
+static uint64_t fnv1a(uint64_t h, void const* data, size_t sz)
+{
+    unsigned char const* bytes = data;
+    for (size_t i = 0; i < sz; ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL; //NOLINT(*magic*)
+    }
+
+    return h;
+}
+
+static uint64_t cmd_hash(uint64_t h, Cmd_repr c)
+{
+    h = fnv1a(h, &c.execute, sizeof c.execute);
+    h = fnv1a(h, &c.ref, sizeof c.ref);
+    h = fnv1a(h, &c.menu, sizeof c.menu);
+    return fnv1a(h, &c.highlight, sizeof c.highlight);
+}
+
+static uint64_t state_hash(State const* s)
+{
+    uint64_t h = 14695981039346656037ULL; //NOLINT(*magic*)
+    h          = fnv1a(h, &s->player, sizeof s->player);
+    h          = fnv1a(h, &s->settings, sizeof s->settings);
+    h          = fnv1a(h, &s->stack_sz, sizeof s->stack_sz);
+    h          = cmd_hash(h, s->curr);
+    for (int i = 0; i < stored_stack(s); ++i) { h = cmd_hash(h, s->stack[i]); }
+
+    return h;
+}
+
+static void table_insert(int id)
+{
+    size_t i = state_hash(&states[id].state) & (size_t)(table_cap - 1);
+    while (table[i] != -1) { i = (i + 1) & (size_t)(table_cap - 1); }
+    table[i] = id;
+}
+
+/*!
+ * \brief Looks up a state, inserting it if it has not been seen before
+ *
+ * \param[in]  s The state to look up
+ * \param[out] inserted Set to true if the state was new
+ *
+ * \returns The id of the state
+ */
+static int intern_state(State const* s, bool* inserted)
+{
+    if (2 * (states_len + 1) > table_cap) {
+        free(table);
+        table_cap = table_cap ? 2 * table_cap : 1024; //NOLINT(*magic*)
+        table     = malloc((size_t)table_cap * sizeof(int));
+        if (!table) { log_and_exit("Out of memory in explore\n"); }
+        memset(table, -1, (size_t)table_cap * sizeof(int));
+        for (int i = 0; i < states_len; ++i) { table_insert(i); }
+    }
+
+    size_t i = state_hash(s) & (size_t)(table_cap - 1);
+    while (table[i] != -1) {
+        if (state_eq(&states[table[i]].state, s)) {
+            *inserted = false;
+            return table[i];
+        }
+        i = (i + 1) & (size_t)(table_cap - 1);
+    }
+
+    GROW(states, states_len, states_cap);
+    states[states_len] = (Explored){.state = *s, .parent = -1};
+    table[i]           = states_len;
+    *inserted          = true;
+
+    return states_len++;
+}
+
+static void enqueue(Job job)
+{
+    GROW(queue, queue_len, queue_cap);
+    queue[queue_len++] = job;
+}
+
+/* <--- Child side ---> */
+
+static Cmd_repr capture(Command* c)
+{
+    Cmd_repr res = {.execute = c->execute};
+    if (c->persistent) { res.ref = c; }
+    else if (c->execute == show_menu) {
+        res.menu      = ((Menu_command*)c)->menu;
+        res.highlight = ((Menu_command*)c)->highlight;
+    }
+
+    return res;
+}
+
+static Command* materialise(Cmd_repr r)
+{
+    if (r.ref) { return (Command*)r.ref; }
+    if (r.execute == show_menu) {
+        return new_menu_command(r.menu, r.highlight);
+    }
+
+    return new_command(r.execute, false);
+}
+
+static State capture_state(Command* curr)
+{
+    State res;
+    memset(&res, 0, sizeof res);
+    res.player   = get_player(child_ctx);
+    res.settings = get_settings(child_ctx);
+    res.curr     = capture(curr);
+    res.stack_sz = command_stack_size(child_ctx);
+    for (int i = 0; i < stored_stack(&res); ++i) {
+        res.stack[i] = capture(command_stack_peek(child_ctx, i));
+    }
+
+    return res;
+}
+
+static void send_record(Record const* rec)
+{
+    if (write(child_fd, rec, sizeof *rec) != (ssize_t)sizeof *rec) {
+        log_and_exit("Failed to report to the explorer\n");
+    }
+}
+
+static bool is_selectable(Option const* o)
+{
+    return !o->command || o->command->execute;
+}
+
+/*!
+ * \brief \ref Menu_selector used in children
+ *
+ * Follows the choices of the job, and picks the first selectable option once
+ * they run out. Every choice is reported to the explorer so that it can
+ * schedule the alternatives.
+ */
+static int explore_selector(Menu const* menu,
+                            int highlight __attribute__((unused)))
+{
+    int selectable[MAX_CHOICES * 4]; //NOLINT(*magic*)
+    int count = 0;
+    for (int i = 0; i < menu->choices_height; ++i) {
+        if (is_selectable(menu->choices[i])) { selectable[count++] = i; }
+    }
+    if (count == 0) { log_and_exit("Menu without selectable options\n"); }
+    if (child_point >= MAX_CHOICES) {
+        log_and_exit("More than %d choices in one transition\n", MAX_CHOICES);
+    }
+
+    int chosen = (child_point < child_job->prefix_len)
+                     ? child_job->prefix[child_point]
+                     : 0;
+    ++child_point;
+
+    Record rec = {.kind   = rec_choice,
+                  .chosen = chosen,
+                  .count  = count,
+                  .label  = menu->choices[selectable[chosen]]->label,
+                  .menu   = menu};
+    send_record(&rec);
+
+    return selectable[chosen];
+}
+
+//! Creates an ncurses screen writing to /dev/null and reading key presses
+//! from a pipe
+static void headless_set_up(void)
+{
+    int in[2];
+    if (pipe(in) != 0) { log_and_exit("pipe failed in %s\n", __func__); }
+
+    char keys[INPUT_BYTES];
+    memset(keys, 'w', sizeof keys);
+    if (write(in[1], keys, sizeof keys) != (ssize_t)sizeof keys) {
+        log_and_exit("Failed to fill the input pipe in %s\n", __func__);
+    }
+    close(in[1]);
+
+    FILE* input  = fdopen(in[0], "r");
+    FILE* output = fopen("/dev/null", "w");
+    if (!input || !output) {
+        log_and_exit("Failed to open streams in %s\n", __func__);
+    }
+
+    SCREEN* s = newterm("xterm", output, input);
+    if (!s) { s = newterm(NULL, output, input); }
+    if (!s) { log_and_exit("newterm failed in %s\n", __func__); }
+
+    noecho();
+    cbreak();
+    nonl();
+    keypad(stdscr, true);
+}
+
+//! Puzzles are assumed to be solved, which returns the command on the stack
+static bool is_puzzle(Command const* c) { return c->execute == paint_sudoku; }
+
+static noreturn void run_transition(Job const* job, int fd, FILE* log)
+{
+    State const* s = &states[job->state].state;
+
+    child_ctx = new_game_context();
+    child_job = job;
+    child_fd  = fd;
+    set_log_output(log);
+    alarm(TIMEOUT_SEC);
+
+    headless_set_up();
+    initialise_menus();
+    restore_player(child_ctx, s->player);
+    restore_settings(child_ctx, s->settings);
+    for (int i = s->stack_sz - 1; i >= 0; --i) {
+        push_command(child_ctx, materialise(s->stack[i]));
+    }
+    set_menu_selector(explore_selector);
+
+    Command* curr = materialise(s->curr);
+    Command* next = is_puzzle(curr) ? pop_command(NULL, child_ctx)
+                                    : curr->execute(curr, child_ctx);
+
+    Record rec = {.kind = rec_state, .state = capture_state(next)};
+    send_record(&rec);
+
+    exit(0);
+}
+
+/* <--- Explorer side ---> */
+
+static void add_problem(int state, Record const* choices, int choices_len,
+                        char const* reason)
+{
+    GROW(problems, problems_len, problems_cap);
+    Problem* p = &problems[problems_len++];
+    *p         = (Problem){.state = state, .via_len = choices_len};
+    for (int i = 0; i < choices_len; ++i) { p->via[i] = choices[i].label; }
+    (void)snprintf(p->reason, sizeof p->reason, "%s", reason);
+}
+
+static void add_state(int from, State const* s, Record const* choices,
+                      int choices_len)
+{
+    if (!s->curr.execute) {
+        ++exits;
+        states[from].can_exit = true;
+        return;
+    }
+
+    bool inserted = false;
+    int id        = intern_state(s, &inserted);
+    GROW(edges, edges_len, edges_cap);
+    edges[edges_len++] = (Edge){from, id};
+    if (!inserted) { return; }
+
+    Explored* e = &states[id];
+    e->parent   = from;
+    e->via_len  = choices_len;
+    for (int i = 0; i < choices_len; ++i) { e->via[i] = choices[i].label; }
+
+    if (s->stack_sz > max_depth) { e->leak = true; }
+    else {
+        enqueue((Job){.state = id});
+    }
+}
+
+/*!
+ * \brief Handles the messages and exit status of a finished child
+ *
+ * Schedules the alternatives to every choice made past the jobs prefix, and
+ * records the resulting state or the problem encountered.
+ */
+static void finish(Running* r, int status)
+{
+    Record choices[MAX_CHOICES];
+    int choices_len = 0;
+    Record rec;
+    bool has_state = false;
+    State next;
+
+    while (read(r->fd, &rec, sizeof rec) == (ssize_t)sizeof rec) {
+        if (rec.kind == rec_state) {
+            has_state = true;
+            next      = rec.state;
+            continue;
+        }
+        for (int i = 0; i < all_menus_len; ++i) {
+            if (all_menus[i] == rec.menu) { menus_seen[i] = true; }
+        }
+        if (choices_len < MAX_CHOICES) { choices[choices_len++] = rec; }
+    }
+    close(r->fd);
+
+    for (int i = r->job.prefix_len; i < choices_len; ++i) {
+        for (int alt = 1; alt < choices[i].count; ++alt) {
+            Job job = {.state = r->job.state, .prefix_len = i + 1};
+            for (int j = 0; j < i; ++j) { job.prefix[j] = choices[j].chosen; }
+            job.prefix[i] = alt;
+            enqueue(job);
+        }
+    }
+
+    ++transitions;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0 && has_state) {
+        add_state(r->job.state, &next, choices, choices_len);
+    }
+    else if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) {
+        add_problem(r->job.state, choices, choices_len, "hang");
+    }
+    else {
+        char line[LOG_LINE_LEN] = "crash";
+        rewind(r->log);
+        if (!fgets(line, sizeof line, r->log)) {
+            (void)snprintf(line, sizeof line, "crash (status %d)", status);
+        }
+        line[strcspn(line, "\n")] = '\0';
+        add_problem(r->job.state, choices, choices_len, line);
+    }
+    (void)fclose(r->log);
+}
+
+static void spawn(Running* r, Job job)
+{
+    int fds[2];
+    if (pipe(fds) != 0) { log_and_exit("pipe failed in %s\n", __func__); }
+    FILE* log = tmpfile();
+    if (!log) { log_and_exit("tmpfile failed in %s\n", __func__); }
+
+    (void)fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) { log_and_exit("fork failed in %s\n", __func__); }
+    if (pid == 0) {
+        close(fds[0]);
+        run_transition(&job, fds[1], log);
+    }
+
+    close(fds[1]);
+    *r = (Running){.pid = pid, .fd = fds[0], .log = log, .job = job};
+}
+
+static void explore(int jobs)
+{
+    Running* running = calloc((size_t)jobs, sizeof(Running));
+    int running_len  = 0;
+
+    while (queue_head < queue_len || running_len > 0) {
+        while (running_len < jobs && queue_head < queue_len) {
+            spawn(&running[running_len++], queue[queue_head++]);
+        }
+
+        int status = 0;
+        pid_t pid  = waitpid(-1, &status, 0);
+        if (pid < 0) { log_and_exit("waitpid failed in %s\n", __func__); }
+        for (int i = 0; i < running_len; ++i) {
+            if (running[i].pid != pid) { continue; }
+            finish(&running[i], status);
+            running[i] = running[--running_len];
+            break;
+        }
+    }
+
+    free(running);
+}
+
+//! Marks every state from which a path to exiting the game exists
+static void propagate_exits(void)
+{
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 0; i < edges_len; ++i) {
+            Explored* from = &states[edges[i].from];
+            if (!from->can_exit && states[edges[i].to].can_exit) {
+                from->can_exit = true;
+                changed        = true;
+            }
+        }
+    }
+}
+
+static char const* menu_name(Menu const* m)
+{
+    for (int i = 0; i < all_menus_len; ++i) {
+        if (all_menus[i] == m) { return all_menu_names[i]; }
+    }
+
+    return "?";
+}
+
+static void print_command(Cmd_repr c)
+{
+    struct
+    {
+        Command const* command;
+        char const* name;
+    } const known[] = {
+        {               &show_glade,          "glade"},
+        {                &show_well,           "well"},
+        {           &return_to_well, "return_to_well"},
+        {&well_raise_bucket_command,   "raise_bucket"},
+        {             &show_options,        "options"},
+        {                    &knock,          "knock"},
+        {        &switch_katte_mode,    "switch_katte"},
+        {              &go_to_cabin,    "go_to_cabin"},
+        {                      &pop,            "pop"},
+    };
+
+    if (c.execute == show_menu) {
+        Menu const* m = c.ref ? ((Menu_command const*)c.ref)->menu : c.menu;
+        printf("menu:%s", menu_name(m));
+        return;
+    }
+    if (c.execute == show_opening) {
+        printf("opening");
+        return;
+    }
+    if (c.execute == return_command) {
+        printf("return");
+        return;
+    }
+    if (c.execute == paint_sudoku) {
+        printf("sudoku");
+        return;
+    }
+    for (size_t i = 0; i < sizeof known / sizeof known[0]; ++i) {
+        if (known[i].command->execute == c.execute) {
+            printf("%s", known[i].name);
+            return;
+        }
+    }
+    printf("<%p>", (void*)c.ref);
+}
+
+static void print_route(int state)
+{
+    if (state < 0) { return; }
+    print_route(states[state].parent);
+    for (int i = 0; i < states[state].via_len; ++i) {
+        printf(" > %s", states[state].via[i]);
+    }
+}
+
+static void print_state(int id)
+{
+    State const* s = &states[id].state;
+    printf("    at ");
+    print_command(s->curr);
+    printf(" stack [");
+    for (int i = 0; i < stored_stack(s); ++i) {
+        printf(i ? ", " : "");
+        print_command(s->stack[i]);
+    }
+    printf("%s]\n    route: start", s->stack_sz > MAX_STACK ? ", ..." : "");
+    print_route(id);
+}
+
+static int report(void)
+{
+    int issues = 0;
+
+    printf("%d states, %d transitions, %d exits\n", states_len, transitions,
+           exits);
+
+    printf("\nCrashes and hangs: %d\n", problems_len);
+    for (int i = 0; i < problems_len && i < REPORT_LIMIT; ++i) {
+        printf("  %s\n", problems[i].reason);
+        print_state(problems[i].state);
+        for (int j = 0; j < problems[i].via_len; ++j) {
+            printf(" > %s", problems[i].via[j]);
+        }
+        printf("\n");
+    }
+    issues += problems_len;
+
+    int count = 0;
+    for (int i = 0; i < states_len; ++i) { count += states[i].leak; }
+    printf("\nStack leaks (stack deeper than %d): %d\n", max_depth, count);
+    for (int i = 0, printed = 0; i < states_len && printed < REPORT_LIMIT;
+         ++i) {
+        if (!states[i].leak) { continue; }
+        print_state(i);
+        printf("\n");
+        ++printed;
+    }
+    issues += count;
+
+    count = 0;
+    for (int i = 0; i < states_len; ++i) {
+        count += !states[i].leak && !states[i].can_exit;
+    }
+    printf("\nDead ends (the game can no longer be exited): %d\n", count);
+    for (int i = 0, printed = 0; i < states_len && printed < REPORT_LIMIT;
+         ++i) {
+        if (states[i].leak || states[i].can_exit) { continue; }
+        print_state(i);
+        printf("\n");
+        ++printed;
+    }
+    issues += count;
+
+    count = 0;
+    for (int i = 0; i < all_menus_len; ++i) { count += !menus_seen[i]; }
+    printf("\nUnreachable menus: %d\n", count);
+    for (int i = 0; i < all_menus_len; ++i) {
+        if (!menus_seen[i]) { printf("  %s\n", all_menu_names[i]); }
+    }
+    issues += count;
+
+    return issues;
+}
+
+int main(int argc, char** argv)
+{
+    int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int opt  = 0;
+    while ((opt = getopt(argc, argv, "j:d:")) != -1) {
+        switch (opt) {
+            case 'j': jobs = atoi(optarg); break;
+            case 'd': max_depth = atoi(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-j jobs] [-d max_stack_depth]\n",
+                        argv[0]);
+                return 2;
+        }
+    }
+    if (jobs < 1) { jobs = 1; }
+    if (max_depth < 0 || max_depth >= MAX_STACK) { max_depth = MAX_STACK - 1; }
+
+    set_log_output(stderr);
+    // Children inherit the headless terminal size
+    char buf[16]; //NOLINT(*magic*)
+    (void)snprintf(buf, sizeof buf, "%d", HEADLESS_LINES);
+    setenv("LINES", buf, 1);
+    (void)snprintf(buf, sizeof buf, "%d", HEADLESS_COLS);
+    setenv("COLUMNS", buf, 1);
+
+    menus_seen = calloc((size_t)all_menus_len, sizeof(bool));
+
+    State root;
+    memset(&root, 0, sizeof root);
+    root.curr = (Cmd_repr){.execute = show_opening};
+    bool inserted = false;
+    enqueue((Job){.state = intern_state(&root, &inserted)});
+
+    explore(jobs);
+    propagate_exits();
+
+    return report() == 0 ? 0 : 1;
+}
@@ -1,18 +1,16 @@
-#include <stdlib.h>
+#include <stdio.h>
 
 #include "base.h"
 #include "start.h"
+#include "state.h"
 
 int main(void)
 {
     init_game();
 
-    Command* curr = start_game();
-    while (curr->execute) {
-        Command* old = curr;
-        curr         = curr->execute(curr);
-        if (!old->persistent) { free(old); }
-    }
+    Context* ctx = new_game_context();
+    run_game(ctx);
+    free_game_context(ctx);
 
     return 0;
 }
@@ -0,0 +1,109 @@
+/*!
+ * \file serve.c
+ * \brief Hosts game sessions for players connecting over a local socket
+ *
+ * Usage: serve [-s LINESxCOLUMNS] [-p | [-j shards | -w watch address]
+ *              [-i idle seconds] [-r recording directory]] <port|socket path>
+ *
+ * With -p every session is played in a process of its own. With -j the
+ * sessions are spread over that many worker processes, each pinned to a CPU;
+ * -j 0 starts one per CPU. Sessions idle for longer than -i seconds are
+ * hibernated to disk until their player presses a key; -i 0 never hibernates.
+ *
+ * With -w spectators may connect to the watch address (a port or socket path)
+ * and send a session number followed by a newline, or just a newline for the
+ * newest session. The number of every session is logged when it starts.
+ *
+ * With -r everything sent to every player is recorded into an asciicast v2
+ * file in the given directory, which asciinema can replay.
+ *
+ * Sessions played with -p are neither hibernated nor recorded, so -i and -r
+ * are rejected with it.
+ *
+ * Every session is played on a terminal of the given size, of the type named
+ * by TERM. tools/client.py connects a terminal to the server.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "server.h"
+
+static void usage(char const* name)
+{
+    fprintf(stderr,
+            "Usage: %s [-s LINESxCOLUMNS] [-p | [-j shards | -w watch address] "
+            "[-i idle seconds] [-r recording directory]] <port|socket path>\n",
+            name);
+    exit(1);
+}
+
+int main(int argc, char** argv)
+{
+    bool prefork      = false;
+    int shards        = -1;
+    char const* watch = NULL;
+    // Set by -i and -r, which don't apply to sessions played with -p
+    bool loop_options = false;
+    int opt           = 0;
+    while ((opt = getopt(argc, argv, "s:j:i:w:r:p")) != -1) {
+        if (opt == 'p') {
+            prefork = true;
+            continue;
+        }
+        if (opt == 'w') {
+            watch = optarg;
+            continue;
+        }
+        if (opt == 'r') {
+            set_recording_dir(optarg);
+            loop_options = true;
+            continue;
+        }
+        if (opt == 'i') {
+            int idle = 0;
+            if (sscanf(optarg, "%d", &idle) != 1 || idle < 0) {
+                usage(argv[0]);
+            }
+            set_idle_timeout(idle);
+            loop_options = true;
+            continue;
+        }
+        if (opt == 'j') {
+            if (sscanf(optarg, "%d", &shards) != 1 || shards < 0) {
+                usage(argv[0]);
+            }
+            continue;
+        }
+        if (opt != 's') { usage(argv[0]); }
+
+        int lines   = 0;
+        int columns = 0;
+        if (sscanf(optarg, "%dx%d", &lines, &columns) != 2 || lines <= 0 ||
+            columns <= 0) {
+            usage(argv[0]);
+        }
+        char buf[16];
+        snprintf(buf, sizeof buf, "%d", lines);
+        setenv("LINES", buf, 1);
+        snprintf(buf, sizeof buf, "%d", columns);
+        setenv("COLUMNS", buf, 1);
+    }
+    if (optind != argc - 1 || prefork + (shards != -1) + (watch != NULL) > 1 ||
+        (prefork && loop_options)) {
+        usage(argv[0]);
+    }
+
+    init_server();
+    int listener = open_listener(argv[optind]);
+    if (prefork) { serve_prefork(listener); }
+    else if (shards == -1) {
+        serve(listener, watch ? open_listener(watch) : -1);
+    }
+    else {
+        serve_sharded(listener, shards);
+    }
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*!
+ * \file accounting.c
+ * \brief Implementation file to \ref accounting.h
+ *
+ * Every tracked allocation is preceded by a header recording its size and
+ * subsystem, so that \ref tracked_free knows what to count without being
+ * told. The header is padded to keep the memory returned aligned for any type.
+ */
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "accounting.h"
+#include "io/logging.h"
+
+typedef union Alloc_header
+{
+    struct
+    {
+        size_t size;
+        Subsystem sub;
+    };
+    max_align_t align;
+} Alloc_header;
+
+//NOLINTBEGIN
+static Alloc_counts totals[SUBSYSTEM_COUNT];
+static Alloc_counts frame[SUBSYSTEM_COUNT];
+//NOLINTEND
+
+static void count_alloc(Subsystem sub, size_t size)
+{
+    ++totals[sub].allocs;
+    ++frame[sub].allocs;
+    totals[sub].live_bytes += (long long)size;
+    frame[sub].live_bytes += (long long)size;
+}
+
+static void count_free(Subsystem sub, size_t size)
+{
+    ++totals[sub].frees;
+    ++frame[sub].frees;
+    totals[sub].live_bytes -= (long long)size;
+    frame[sub].live_bytes -= (long long)size;
+}
+
+static void* track(Alloc_header* h, Subsystem sub, size_t size)
+{
+    if (!h) { log_and_exit("Out of memory in %s\n", __func__); }
+    h->size = size;
+    h->sub  = sub;
+    count_alloc(sub, size);
+    return h + 1;
+}
+
+void* tracked_malloc(Subsystem sub, size_t size)
+{
+    return track((Alloc_header*)malloc(sizeof(Alloc_header) + size), sub,
+                 size);
+}
+
+void* tracked_calloc(Subsystem sub, size_t count, size_t size)
+{
+    if (size != 0 && count > SIZE_MAX / size) {
+        log_and_exit("Out of memory in %s\n", __func__);
+    }
+    void* res = tracked_malloc(sub, count * size);
+    memset(res, 0, count * size);
+    return res;
+}
+
+void* tracked_realloc(Subsystem sub, void* p, size_t size)
+{
+    if (!p) { return tracked_malloc(sub, size); }
+
+    Alloc_header* h = (Alloc_header*)p - 1;
+    count_free(h->sub, h->size);
+    return track((Alloc_header*)realloc(h, sizeof(Alloc_header) + size), sub,
+                 size);
+}
+
+void tracked_free(void* p)
+{
+    if (!p) { return; }
+
+    Alloc_header* h = (Alloc_header*)p - 1;
+    count_free(h->sub, h->size);
+    free(h);
+}
+
+Alloc_counts alloc_counts(Subsystem sub) { return totals[sub]; }
+
+Alloc_counts frame_alloc_counts(Subsystem sub) { return frame[sub]; }
+
+void start_alloc_frame(void) { memset(frame, 0, sizeof frame); }
+
+char const* subsystem_name(Subsystem sub)
+{
+    static char const* const names[SUBSYSTEM_COUNT] = {
+        [sub_vec] = "vec",   [sub_arena] = "arena", [sub_menu] = "menu",
+        [sub_base] = "base", [sub_utf8] = "utf8",
+        [sub_application] = "application", [sub_window] = "window"};
+    return names[sub];
+}
@@ -0,0 +1,64 @@
+/*!
+ * \file accounting.h
+ * \brief Counting the heap allocations of every subsystem
+ *
+ * Memory that a subsystem allocates through \ref tracked_malloc and friends is
+ * counted towards it, both in total and for the current frame (the work done
+ * in response to a single key, see \ref read_key). This makes leaks, and
+ * allocations in loops that should have reached a steady state, show up as
+ * numbers that tests can check.
+ *
+ * Memory from \ref tracked_malloc must be released with \ref tracked_free, and
+ * never with free.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+//! The parts of the program that allocations are counted towards
+typedef enum Subsystem
+{
+    sub_vec,
+    sub_arena,
+    sub_menu,
+    sub_base,
+    sub_utf8,
+    sub_application,
+    sub_window,
+    SUBSYSTEM_COUNT
+} Subsystem;
+
+//! Allocation counts of a subsystem
+typedef struct Alloc_counts
+{
+    long allocs;
+    long frees;
+    //! Bytes allocated and not yet freed, negative if a frame freed more
+    //! than it allocated
+    long long live_bytes;
+} Alloc_counts;
+
+//! malloc counted towards sub, exits the program when out of memory
+void* tracked_malloc(Subsystem sub, size_t size);
+
+//! calloc counted towards sub, exits the program when out of memory
+void* tracked_calloc(Subsystem sub, size_t count, size_t size);
+
+//! realloc of memory from sub, counted as a free followed by an allocation
+void* tracked_realloc(Subsystem sub, void* p, size_t size);
+
+//! Frees p, which must come from a tracked allocation or be NULL
+void tracked_free(void* p);
+
+//! Returns the counts of sub since the program started
+Alloc_counts alloc_counts(Subsystem sub);
+
+//! Returns the counts of sub since \ref start_alloc_frame was last called
+Alloc_counts frame_alloc_counts(Subsystem sub);
+
+//! Starts counting a new frame
+void start_alloc_frame(void);
+
+//! Returns the name of sub, e.g. for reports
+char const* subsystem_name(Subsystem sub);
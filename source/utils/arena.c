@@ -0,0 +1,88 @@
+/*!
+ * \file arena.c
+ * \brief Implementation file to \ref arena.h
+ *
+ * An arena allocates from the first of its blocks. When that is full, a block
+ * at least twice as large is put in front of it. Resetting an arena that had
+ * to grow replaces all its blocks with a single one as large as all of them,
+ * so that the next frame fits without growing again.
+ */
+
+#include <stdalign.h>
+#include <stddef.h>
+
+#include "accounting.h"
+#include "arena.h"
+
+enum
+{
+    FIRST_BLOCK_SZ = 16 * 1024
+};
+
+struct Arena_block
+{
+    struct Arena_block* next;
+    size_t cap;
+    alignas(max_align_t) char data[];
+};
+
+static struct Arena_block* new_block(size_t cap, struct Arena_block* next)
+{
+    struct Arena_block* b =
+        (struct Arena_block*)tracked_malloc(sub_arena,
+                                            sizeof(struct Arena_block) + cap);
+    b->next = next;
+    b->cap  = cap;
+    return b;
+}
+
+void* arena_alloc(Arena* arena, size_t size)
+{
+    size_t const align = alignof(max_align_t);
+    size               = (size + align - 1) / align * align;
+
+    struct Arena_block* b = arena->blocks;
+    if (!b || arena->used + size > b->cap) {
+        size_t cap = b ? 2 * b->cap : FIRST_BLOCK_SZ;
+        while (cap < size) { cap *= 2; }
+        arena->blocks = new_block(cap, b);
+        arena->used   = 0;
+    }
+
+    void* res = arena->blocks->data + arena->used;
+    arena->used += size;
+    return res;
+}
+
+void arena_reset(Arena* arena)
+{
+    struct Arena_block* b = arena->blocks;
+    arena->used           = 0;
+    if (!b || !b->next) { return; }
+
+    size_t total = 0;
+    while (b) {
+        struct Arena_block* next = b->next;
+        total += b->cap;
+        tracked_free(b);
+        b = next;
+    }
+    arena->blocks = new_block(total, NULL);
+}
+
+void free_arena(Arena* arena)
+{
+    struct Arena_block* b = arena->blocks;
+    while (b) {
+        struct Arena_block* next = b->next;
+        tracked_free(b);
+        b = next;
+    }
+    *arena = (Arena){0};
+}
+
+Arena* frame_arena(void)
+{
+    static Arena frame = {0}; //NOLINT
+    return &frame;
+}
@@ -0,0 +1,40 @@
+/*!
+ * \file arena.h
+ * \brief Bump allocator for memory that only lives for a short while
+ *
+ * Allocating from an arena is a pointer increment; nothing is freed on its
+ * own, everything is released at once by \ref arena_reset. Once an arena has
+ * grown to what it is used for, it stops calling malloc altogether.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+struct Arena_block;
+
+typedef struct Arena
+{
+    //! The block allocated from, followed by any blocks it outgrew
+    struct Arena_block* blocks;
+    //! Bytes used in the first block
+    size_t used;
+} Arena;
+
+//! Returns size bytes aligned for any type, valid until the next \ref
+//! arena_reset
+void* arena_alloc(Arena* arena, size_t size);
+
+//! Releases everything allocated from arena, keeping its memory for reuse
+void arena_reset(Arena* arena);
+
+//! Returns the memory of arena to the system
+void free_arena(Arena* arena);
+
+/*!
+ * \brief The arena for transient allocations of the current frame
+ *
+ * It is reset whenever a key is read (see \ref read_key), so nothing
+ * allocated from it may be kept across reading a key.
+ */
+Arena* frame_arena(void);
@@ -1,6 +1,7 @@
 #include <ncurses.h>
 #include <stdlib.h>
 
+#include "accounting.h"
 #include "base.h"
 #include "io/logging.h"
 
@@ -11,61 +12,79 @@ typedef struct Node
     Command* val;
 } Node;
 
-Command* new_command(Command* (*execute)(void*), bool persistent)
+Command* new_command(Command* (*execute)(void*, Context*), bool persistent)
 {
-    Command* res    = (Command*)malloc(sizeof(Command));
+    Command* res    = (Command*)tracked_malloc(sub_base, sizeof(Command));
     res->execute    = execute;
     res->persistent = persistent;
 
     return res;
 }
 
-Command* return_command(void* this)
+Command* return_command(void* this, Context* _ __attribute__((unused)))
 {
     return ((Return_command*)this)->return_value;
 }
 
-/*!
- * Global command stack for storing commands that are to be restored later.
- *
- * If for example you have a command that prints some options, and that can be
- * called from state A, B and C, you could store a command that will restore the
- * correct state out of A, B and C and then have the options menu return the
- * command on the stack whenever it is done (i.e the \ref Option of the exit
- * option has \ref pop_command as it's command member).
- *
- * This variable should be manipulated using \ref push_command and \ref pop_func
- */
-static Node* command_stack = NULL; //NOLINT
-
 Command const null_command = {.execute = NULL, .persistent = true};
 
 Command const pop = {.execute = pop_command, .persistent = true};
 
-void push_command(Command* f)
+void push_command(Context* ctx, Command* f)
 {
-    Node* curr = (Node*)malloc(sizeof(Node));
+    Node* curr = (Node*)tracked_malloc(sub_base, sizeof(Node));
 
     curr->val  = f;
-    curr->next = command_stack;
+    curr->next = ctx->command_stack;
 
-    command_stack = curr;
+    ctx->command_stack = curr;
 }
 
-Command* pop_command(void* _ __attribute__((unused)))
+Command* pop_command(void* _ __attribute__((unused)), Context* ctx)
 {
-    if (!command_stack) { log_and_exit("Empty command stack popped\n"); }
+    if (!ctx->command_stack) { log_and_exit("Empty command stack popped\n"); }
 
-    Node* popped = command_stack;
+    Node* popped = ctx->command_stack;
 
-    command_stack = command_stack->next;
+    ctx->command_stack = ctx->command_stack->next;
 
     Command* res = popped->val;
-    free(popped);
+    tracked_free(popped);
+
+    return res;
+}
+
+int command_stack_size(Context const* ctx)
+{
+    int res = 0;
+    for (Node* curr = ctx->command_stack; curr; curr = curr->next) { ++res; }
 
     return res;
 }
 
+/*!
+ * \param[in] i The depth of the command, where 0 is the top of the stack
+ *
+ * \returns The command at depth i, the program exits if the stack is not deep
+ * enough
+ */
+Command* command_stack_peek(Context const* ctx, int i)
+{
+    Node* curr = ctx->command_stack;
+    for (; curr && i > 0; --i) { curr = curr->next; }
+    if (!curr) { log_and_exit("Command stack peeked out of bounds\n"); }
+
+    return curr->val;
+}
+
+void clear_command_stack(Context* ctx)
+{
+    while (ctx->command_stack) {
+        Command* c = pop_command(NULL, ctx);
+        if (!c->persistent) { tracked_free(c); }
+    }
+}
+
 void init_color_pairs(void)
 {
     init_pair(1, COLOR_YELLOW, COLOR_BLACK);
@@ -10,6 +10,47 @@ enum color
     col_red
 };
 
+/*!
+ * \brief State belonging to a single game session
+ *
+ * Everything a session changes while it is being played lives in its Context
+ * rather than in globals, so that one process can host many sessions. The
+ * Context is passed to every \ref Command::execute.
+ *
+ * Applications keep their own per-session state by "deriving" from Context,
+ * i.e. by placing it as the first member of a larger struct.
+ */
+typedef struct Context
+{
+    //! Commands that are to be restored later, see \ref push_command
+    struct Node* command_stack;
+    //! The command currently being executed by the game loop
+    struct Command* running;
+    //! Command restarting the session from where it waits for input, or NULL
+    struct Command* checkpoint;
+    //! Set while a global key is handled, see \ref read_input
+    bool in_global_key;
+} Context;
+
+/* <--- Context members ---> */
+/*!
+ * \var Context::command_stack
+ * If for example you have a command that prints some options, and that can be
+ * called from state A, B and C, you could store a command that will restore the
+ * correct state out of A, B and C and then have the options menu return the
+ * command on the stack whenever it is done (i.e the \ref Option of the exit
+ * option has \ref pop_command as it's command member).
+ *
+ * The stack should be manipulated using \ref push_command and \ref pop_command
+ *
+ * \var Context::checkpoint
+ * Set by code that waits for input at a point that can be recreated, e.g. a
+ * menu with its highlighted choice, and reset to NULL once the input has been
+ * read. Executing it in place of \ref Context::running redraws that point and
+ * continues the game from there, which lets a host put an idle session away
+ * and restore it later.
+ */
+
 /*!
  * \brief Recursive command at the center of the games functionality
  *
@@ -25,12 +66,12 @@ enum color
 typedef struct Command
 {
     //! The "member function" associated with the Command
-    struct Command* (*execute)(void*);
+    struct Command* (*execute)(void*, Context*);
     bool persistent;
 } Command;
 
 //! Constructor for Command
-Command* new_command(Command* (*execute)(void*), bool persistent);
+Command* new_command(Command* (*execute)(void*, Context*), bool persistent);
 
 /* <--- Command members ---> */
 /*!
@@ -46,6 +87,8 @@ Command* new_command(Command* (*execute)(void*), bool persistent);
  * to be called. However, most functions will require arguments in order to be
  * flexible or do what we want, and in the main loop we have to have the same
  * signature for every function.
+ *
+ * The second argument is the \ref Context of the session being played.
  */
 
 /*!
@@ -61,12 +104,18 @@ typedef struct Return_command
     Command* return_value;
 } Return_command;
 
-Command* return_command(void* this);
+Command* return_command(void* this, Context* ctx);
 
-//! Pushes a command on to the global \ref func_stack
-void push_command(Command* f);
-//! Pops a command of the global \ref func_stack
-Command* pop_command(void*);
+//! Pushes a command on to the command stack of ctx
+void push_command(Context* ctx, Command* f);
+//! Pops a command of the command stack of ctx
+Command* pop_command(void*, Context* ctx);
+//! Returns the number of commands on the command stack of ctx
+int command_stack_size(Context const* ctx);
+//! Returns the command i steps below the top of the command stack of ctx
+Command* command_stack_peek(Context const* ctx, int i);
+//! Empties the command stack of ctx, freeing non-persistent commands
+void clear_command_stack(Context* ctx);
 
 //Standard commands
 
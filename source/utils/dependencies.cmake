@@ -1,17 +1,35 @@
 # base dependencies 
-target_link_libraries(base PRIVATE logging)
+target_link_libraries(base PRIVATE accounting logging)
+
+# accounting dependencies
+target_link_libraries(accounting PRIVATE logging)
+
+# arena dependencies
+target_link_libraries(arena PRIVATE accounting)
+
+# vec dependencies
+target_link_libraries(vec PRIVATE accounting arena)
+
+# window_pool dependencies
+target_link_libraries(window_pool PRIVATE ${ncursesLib})
 
 # utf8 dependencies
-target_link_libraries(utf8 PRIVATE logging)
+target_link_libraries(utf8 PRIVATE accounting arena logging window_pool ${ncursesLib})
+
+# keys dependencies
+target_link_libraries(keys PRIVATE base utf8 logging ${ncursesLib})
+
+# recorder dependencies
+target_link_libraries(recorder PRIVATE logging Threads::Threads)
 
 
 # menu dependencies
 target_include_directories(menu PRIVATE ${configDir})
-target_link_libraries(menu PRIVATE utf8 logging ${ncursesLib})
+target_link_libraries(menu PRIVATE accounting arena utf8 keys logging window_pool ${ncursesLib})
 
 # Games subdirectory
 # witness dependencies
-target_link_libraries(witness PRIVATE utf8 vec logging base ${ncursesLib})
+target_link_libraries(witness PRIVATE arena utf8 keys vec logging base window_pool ${ncursesLib})
 # sudoku dependencies
-target_link_libraries(sudoku PRIVATE base ${ncursesLib})
+target_link_libraries(sudoku PRIVATE base utf8 keys window_pool ${ncursesLib})
 
@@ -3,7 +3,10 @@
 #include <string.h>
 
 #include "base.h"
+#include "io/keys.h"
+#include "io/utf8.h"
 #include "sudoku.h"
+#include "window_pool.h"
 
 char const* const sudoku_board[] = {
     "╔═══╦═══╦═══╦═══╦═══╦═══╦═══════════╗",
@@ -34,6 +37,24 @@ enum
     SUDOKU_SZ          = 9
 };
 
+//NOLINTBEGIN
+//! \ref sudoku_board as cells, converted once by \ref sudoku_board_cells
+static cchar_t board_cells[SUDOKU_CHAR_HEIGHT][SUDOKU_CHAR_WIDTH + 1];
+static bool board_converted = false;
+//NOLINTEND
+
+//! Returns the line i of \ref sudoku_board as cells, ended by an empty cell
+static cchar_t const* sudoku_board_cells(int i)
+{
+    if (!board_converted) {
+        for (int j = 0; j < SUDOKU_CHAR_HEIGHT; ++j) {
+            utf8_to_cells(sudoku_board[j], -1, A_NORMAL, board_cells[j]);
+        }
+        board_converted = true;
+    }
+    return board_cells[i];
+}
+
 int sudoku_xcoord(int x) { return 2 + 4 * x; }
 
 int sudoku_ycoord(int y) { return 1 + 2 * y; }
@@ -53,14 +74,14 @@ WINDOW* paint_sudoku_board(int* board)
     int const width  = SUDOKU_CHAR_WIDTH;
     int x_pos        = (COLS - width) / 2;
     int y_pos        = (LINES - height) / 2;
-    WINDOW* s_win    = newwin(height, width, y_pos, x_pos);
+    WINDOW* s_win    = take_window(height, width, y_pos, x_pos);
 
     intrflush(s_win, true);
     keypad(s_win, true);
 
 
     for (int i = 0; i < height; ++i) {
-        mvwaddstr(s_win, i, 0, sudoku_board[i]);
+        mvwadd_wchnstr(s_win, i, 0, sudoku_board_cells(i), -1);
     }
 
     int const side_len = 9;
@@ -74,7 +95,7 @@ WINDOW* paint_sudoku_board(int* board)
         }
     }
 
-    wrefresh(s_win);
+    stage_window(s_win);
     return s_win;
 }
 
@@ -161,54 +182,93 @@ bool sudoku_is_solved(int const* board)
     return true;
 }
 
-void play_sudoku(WINDOW* suk_win, Sudoku_command* sc)
+//! Moves the square at (*y, *x) in a direction, returns false for other actions
+static bool move_sudoku_cursor(Action action, int* y, int* x)
 {
-    int y = 0;
-    int x = 0;
-    int board[SUDOKU_SZ][SUDOKU_SZ];
+    switch (action) {
+        case act_up:
+            if (*y > 0) { --*y; }
+            break;
+        case act_down:
+            if (*y < SUDOKU_SZ - 1) { ++*y; }
+            break;
+        case act_left:
+            if (*x > 0) { --*x; }
+            break;
+        case act_right:
+            if (*x < SUDOKU_SZ - 1) { ++*x; }
+            break;
+        default: return false;
+    }
+    return true;
+}
 
-    memcpy(board, sc->board, sizeof board);
+void play_sudoku(WINDOW* suk_win, Sudoku_progress* p, Context* ctx)
+{
+    Sudoku_command const* sc = p->puzzle;
+    int(*board)[SUDOKU_SZ]   = p->board;
+    int y                    = p->y;
+    int x                    = p->x;
+
+    //Squares filled in before the game was resumed
+    wattrset(suk_win, A_REVERSE);
+    for (int i = 0; i < SUDOKU_SZ; ++i) {
+        for (int j = 0; j < SUDOKU_SZ; ++j) {
+            if (sc->board[i][j] == 0 && board[i][j] != 0) {
+                paint_sudoku_sq(suk_win, i, j, board[i][j]);
+            }
+        }
+    }
 
     wattrset(suk_win, A_BLINK | A_REVERSE);
-    paint_sudoku_sq(suk_win, 0, 0, board[0][0]);
-    wrefresh(suk_win);
+    paint_sudoku_sq(suk_win, y, x, board[y][x]);
+    stage_window(suk_win);
 
     while (!sudoku_is_solved((int*)board)) {
-        int ch = wgetch(suk_win);
+        p->y            = y;
+        p->x            = x;
+        ctx->checkpoint = (Command*)p;
+        Input_event in  = read_input(ctx, suk_win);
+        ctx->checkpoint = NULL;
+        if (in.action == act_resize) {
+            move_window(suk_win, SUDOKU_CHAR_HEIGHT, SUDOKU_CHAR_WIDTH,
+                        (LINES - SUDOKU_CHAR_HEIGHT) / 2,
+                        (COLS - SUDOKU_CHAR_WIDTH) / 2);
+            continue;
+        }
+
+        int const from_y = y;
+        int const from_x = x;
+        bool const moved = move_sudoku_cursor(in.action, &y, &x);
+        if (moved) {
+            // Directions queued up behind in move on before anything is drawn
+            while (read_queued_input(suk_win, is_direction_input, &in)) {
+                move_sudoku_cursor(in.action, &y, &x);
+            }
+        }
 
         //If square we're leaving was originally empty but has been filled in,
         //we give it reverse effect
-        if (sc->board[y][x] == 0 && board[y][x] != 0) {
+        if (sc->board[from_y][from_x] == 0 && board[from_y][from_x] != 0) {
             wattrset(suk_win, A_REVERSE);
-            paint_sudoku_sq(suk_win, y, x, board[y][x]);
+            paint_sudoku_sq(suk_win, from_y, from_x, board[from_y][from_x]);
         }
         //Otherwise (empty square or one that was originally filled) we leave it
         //with the normal effect
         else {
             wattrset(suk_win, A_NORMAL);
-            paint_sudoku_sq(suk_win, y, x, board[y][x]);
+            paint_sudoku_sq(suk_win, from_y, from_x, board[from_y][from_x]);
         }
 
-        switch (ch) {
-            case KEY_UP:
-                if (y > 0) { --y; }
-                break;
-            case KEY_DOWN:
-                if (y < SUDOKU_SZ - 1) { ++y; }
-                break;
-            case KEY_LEFT:
-                if (x > 0) { --x; }
-                break;
-            case KEY_RIGHT:
-                if (x < SUDOKU_SZ - 1) { ++x; }
-                break;
+        switch (in.key) {
 #ifdef DEBUG_FUNCTIONALITY
             case ' ': return;
 #endif
             default:
                 //If input was a digit, we fill the square in if possible
-                if ('0' <= ch && ch <= '9' && sc->board[y][x] == 0) {
-                    board[y][x] = ch - '0';
+                if (!moved && '0' <= in.key && in.key <= '9' &&
+                    sc->board[y][x] == 0) {
+                    board[y][x] = in.key - '0';
                     paint_sudoku_sq(suk_win, y, x, board[y][x]);
                 }
                 break;
@@ -241,22 +301,31 @@ void sudoku_test(void)
     //NOLINTEND
 }
 
-Command* paint_sudoku(void* this)
+Command* resume_sudoku(void* this, Context* ctx)
+{
+    Sudoku_progress* p = (Sudoku_progress*)this;
+    WINDOW* suk_win    = paint_sudoku_board((int*)p->puzzle->board);
+
+    play_sudoku(suk_win, p, ctx);
+
+    release_window(suk_win);
+
+    return (Command*)&pop;
+}
+
+Command* paint_sudoku(void* this, Context* ctx)
 {
 #ifndef NDEBUG
     sudoku_test();
 #endif
 
-    Sudoku_command* sc = (Sudoku_command*)this;
-    WINDOW* suk_win    = paint_sudoku_board((int*)sc->board);
-
-    play_sudoku(suk_win, sc);
-
-    werase(suk_win);
-    wrefresh(suk_win);
-    delwin(suk_win);
+    Sudoku_progress p = {
+        .command = {.execute = resume_sudoku, .persistent = true},
+        .puzzle  = (Sudoku_command*)this
+    };
+    memcpy(p.board, p.puzzle->board, sizeof p.board);
 
-    return (Command*)&pop;
+    return resume_sudoku(&p, ctx);
 }
 
 //TODO: Remove
@@ -293,5 +362,6 @@ void test_sudoku(void)
     };
     //NOLINTEND
 
-    paint_sudoku(&sc);
+    Context ctx = {0};
+    paint_sudoku(&sc, &ctx);
 }
@@ -8,4 +8,27 @@ typedef struct Sudoku_command
     int board[9][9]; //NOLINT
 } Sudoku_command;
 
-Command* paint_sudoku(void* this);
+/*!
+ * \brief A sudoku in the middle of being played
+ *
+ * Serves as the \ref Context::checkpoint while the game waits for a key.
+ * Executing it repaints the board and continues the game.
+ */
+typedef struct Sudoku_progress
+{
+    //! Base class - see \ref Command documentation
+    Command command;
+    //! The puzzle being played, its filled in squares cannot be changed
+    Sudoku_command const* puzzle;
+    //! The puzzle with the squares filled in so far
+    int board[9][9]; //NOLINT
+    //! Row of the selected square
+    int y;
+    //! Column of the selected square
+    int x;
+} Sudoku_progress;
+
+Command* paint_sudoku(void* this, Context* ctx);
+
+//! \ref Command::execute "Execute" that continues a \ref Sudoku_progress
+Command* resume_sudoku(void* this, Context* ctx);
@@ -9,11 +9,14 @@
 #include <stddef.h>
 #include <stdlib.h>
 
+#include "arena.h"
 #include "base.h"
+#include "io/keys.h"
 #include "io/logging.h"
 #include "io/utf8.h"
 #include "vec.h"
 #include "witness.h"
+#include "window_pool.h"
 
 //! Commandtion for converting enum to string literal
 char const* we_enum_to_str(enum Witness_enum we)
@@ -59,6 +62,92 @@ Dir opposite(Dir d)
     }
 }
 
+//! The pieces the walls and the path of the board are painted with
+typedef enum Glyph
+{
+    gl_top_left,
+    gl_top,
+    gl_top_right,
+    gl_middle_left,
+    gl_middle,
+    gl_middle_right,
+    gl_bottom_left,
+    gl_bottom,
+    gl_bottom_right,
+    gl_wall,
+    gl_wall_right,
+    gl_path_v,
+    gl_path_h,
+    gl_path_v_left,
+    gl_path_v_right,
+    gl_path_v_cross,
+    gl_path_h_down,
+    gl_path_h_up,
+    gl_path_h_cross,
+    gl_path_down_left,
+    gl_path_down_right,
+    gl_path_up_left,
+    gl_path_up_right,
+    GLYPH_COUNT
+} Glyph;
+
+enum
+{
+    //! The most columns of a glyph, the width of a square
+    GLYPH_MAX_WIDTH = 4
+};
+
+//! What every \ref Glyph looks like, the walls a square wide
+static char const* const glyph_art[GLYPH_COUNT] = {
+    [gl_top_left]        = "┌───",
+    [gl_top]             = "┬───",
+    [gl_top_right]       = "┐",
+    [gl_middle_left]     = "├───",
+    [gl_middle]          = "┼───",
+    [gl_middle_right]    = "┤",
+    [gl_bottom_left]     = "└───",
+    [gl_bottom]          = "┴───",
+    [gl_bottom_right]    = "┘",
+    [gl_wall]            = "│   ",
+    [gl_wall_right]      = "│",
+    [gl_path_v]          = "║",
+    [gl_path_h]          = "═",
+    [gl_path_v_left]     = "╢",
+    [gl_path_v_right]    = "╟",
+    [gl_path_v_cross]    = "╫",
+    [gl_path_h_down]     = "╤",
+    [gl_path_h_up]       = "╧",
+    [gl_path_h_cross]    = "╪",
+    [gl_path_down_left]  = "╗",
+    [gl_path_down_right] = "╔",
+    [gl_path_up_left]    = "╝",
+    [gl_path_up_right]   = "╚",
+};
+
+//NOLINTBEGIN
+//! The glyphs as cells, converted once by \ref glyph_cells
+static cchar_t glyph_cell_lines[GLYPH_COUNT][GLYPH_MAX_WIDTH + 1];
+static bool glyphs_converted = false;
+//NOLINTEND
+
+//! Returns the cells of g, ended by an empty cell
+static cchar_t const* glyph_cells(Glyph g)
+{
+    if (!glyphs_converted) {
+        for (int i = 0; i < GLYPH_COUNT; ++i) {
+            utf8_to_cells(glyph_art[i], -1, A_NORMAL, glyph_cell_lines[i]);
+        }
+        glyphs_converted = true;
+    }
+    return glyph_cell_lines[g];
+}
+
+//! Paints a glyph of the path, in the attributes of win unlike walls
+static void paint_glyph(WINDOW* win, int y, int x, Glyph g)
+{
+    mvwadd_wch(win, y, x, glyph_cells(g));
+}
+
 //! Example groups to be used in the game
 Group const groups[] = {
     {.color = col_default,  .symbol = ""},
@@ -156,33 +245,38 @@ Sq* get_p(Witness* wc, coord c)
  */
 void print_witness_line(WINDOW* win, Witness* wc, int line)
 {
-    wmove(win, line, 0);
+    Glyph first = gl_wall;
+    Glyph piece = gl_wall;
+    Glyph last  = gl_wall_right;
     if (line == 0) {
-        waddstr(win, "┌───");
-        for (int i = 1; i < wc->width; ++i) { waddstr(win, "┬───"); }
-        waddstr(win, "┐");
-        return;
-    }
-    if (line == 2 * wc->height) {
-        waddstr(win, "└───");
-        for (int i = 1; i < wc->width; ++i) { waddstr(win, "┴───"); }
-        waddstr(win, "┘");
-        return;
-    }
-
-    switch (line % 2) {
-        case 0:
-            waddstr(win, "├───");
-            for (int i = 1; i < wc->width; ++i) { waddstr(win, "┼───"); }
-            waddstr(win, "┤");
-            return;
-        case 1:
-            waddstr(win, "│   ");
-            for (int i = 1; i < wc->width; ++i) { waddstr(win, "│   "); }
-            waddstr(win, "│");
-            return;
-        default: log_and_exit("Impossible branch reached, aborting...\n");
+        first = gl_top_left;
+        piece = gl_top;
+        last  = gl_top_right;
+    }
+    else if (line == 2 * wc->height) {
+        first = gl_bottom_left;
+        piece = gl_bottom;
+        last  = gl_bottom_right;
+    }
+    else {
+        switch (line % 2) {
+            case 0:
+                first = gl_middle_left;
+                piece = gl_middle;
+                last  = gl_middle_right;
+                break;
+            case 1: break;
+            default: log_and_exit("Impossible branch reached, aborting...\n");
+        }
+    }
+
+    mvwadd_wchnstr(win, line, 0, glyph_cells(first), -1);
+    for (int i = 1; i < wc->width; ++i) {
+        mvwadd_wchnstr(win, line, get_scr_pos((coord){0, i}).x,
+                       glyph_cells(piece), -1);
     }
+    mvwadd_wchnstr(win, line, get_scr_pos((coord){0, wc->width}).x,
+                   glyph_cells(last), -1);
 }
 
 //! Return the coordinate obtained by stepping one step in direction d from
@@ -238,6 +332,7 @@ void get_walls(coord c, coord cs[2], Dir d)
 /*!
  * \brief Returns all the squares connected to a specific square
  *
+ * \param[in] arena The arena to allocate the result from, or NULL for the heap
  * \param[in] wc The witness whose board we wish to inspect
  * \param[in] c The coordinate of the square to inspect
  *
@@ -245,11 +340,11 @@ void get_walls(coord c, coord cs[2], Dir d)
  * specified (i.e have not been sectioned off from each other by the players
  * path)
  */
-Vec_coord get_area(Witness* wc, coord c)
+Vec_coord get_area_in(Arena* arena, Witness* wc, coord c)
 {
     int const init_cap   = 16;
-    Vec_coord res        = new_vec_coord(init_cap);
-    Vec_coord back_track = new_vec_coord(init_cap);
+    Vec_coord res        = new_vec_coord_in(arena, init_cap);
+    Vec_coord back_track = new_vec_coord_in(arena, init_cap);
     VEC_PUSH(&back_track, c);
 
     while (back_track.sz > 0) {
@@ -270,45 +365,47 @@ Vec_coord get_area(Witness* wc, coord c)
     return res;
 }
 
+//! \ref get_area_in on the heap
+Vec_coord get_area(Witness* wc, coord c) { return get_area_in(NULL, wc, c); }
+
 /*!
  * \brief Verifies if a witness puzzle has been solved
  *
  * Checks if the witness puzzle has been correctly divided and if the player has
  * reached the end (notably does not verify if all points have been acquired
  * yet).
+ *
+ * The areas are allocated from the \ref frame_arena.
  */
 bool witness_is_solved(Witness* wc)
 {
     if (VEC_BACK(wc->pos).x != wc->end.x || VEC_BACK(wc->pos).y != wc->end.y) {
         return false;
     }
-    Vec_coord visited = new_vec_coord(wc->width * wc->height);
+    Arena* arena      = frame_arena();
+    Vec_coord visited = new_vec_coord_in(arena, wc->width * wc->height);
     for (int i = 0; i < wc->height; ++i) {
         for (int j = 0; j < wc->width; ++j) {
             coord temp = {i, j};
             if (VEC_CONTAINS(visited, temp)) { continue; }
 
-            Vec_coord v = get_area(wc, temp);
+            Vec_coord v = get_area_in(arena, wc, temp);
             //Verify that all squares in the same area are of same color (or
             //colorless)
             int color = -1;
-            while (v.sz > 0) {
-                coord c = VEC_POP(&v);
-                int clr = get(wc, c).group.color;
+            for (int k = 0; k < v.sz; ++k) {
+                int clr = get(wc, v.data[k]).group.color;
                 if (clr != col_default) {
                     if (color == -1) { color = clr; }
                     else if (color != clr) {
                         return false;
                     }
                 }
+                VEC_PUSH(&visited, v.data[k]);
             }
-            for (int i = 0; i < v.sz; ++i) { VEC_PUSH(&visited, v.data[i]); }
-
-            free_vec(&v);
         }
     }
 
-    free_vec(&visited);
     return true;
 }
 
@@ -325,7 +422,7 @@ WINDOW* create_witness_win(Witness* wc)
 {
     int const ht = 1 + 2 * wc->height;
     int const wd = 1 + 4 * wc->width;
-    WINDOW* win  = newwin(ht, wd, (LINES - ht) / 2, (COLS - wd) / 2);
+    WINDOW* win  = take_window(ht, wd, (LINES - ht) / 2, (COLS - wd) / 2);
     intrflush(win, false);
     keypad(win, true);
 
@@ -409,17 +506,17 @@ void paint_up(Witness* wc, WINDOW* win, coord c, Dir point)
 {
     VERIFY_PAINT_CONDITIONS(wc, c, dir_up, point);
 
-    char const* final_pipe = NULL;
+    Glyph final_pipe = GLYPH_COUNT;
     switch (point) {
         case dir_up:
             if (c.x == wc->width) {
-                final_pipe = "╢";
+                final_pipe = gl_path_v_left;
                 break;
             }
-            final_pipe = (c.x == 0) ? "╫" : "╟";
+            final_pipe = (c.x == 0) ? gl_path_v_cross : gl_path_v_right;
             break;
-        case dir_left : final_pipe = "╗"; break;
-        case dir_right: final_pipe = "╔"; break;
+        case dir_left : final_pipe = gl_path_down_left; break;
+        case dir_right: final_pipe = gl_path_down_right; break;
         default:
             log_and_exit("Invalid point direction in %s, aborting...\n",
                          __func__);
@@ -427,26 +524,26 @@ void paint_up(Witness* wc, WINDOW* win, coord c, Dir point)
 
     coord scr_pos = get_scr_pos(c);
 
-    mvwaddstr(win, scr_pos.y - 2, scr_pos.x, final_pipe);
-    mvwaddstr(win, scr_pos.y - 1, scr_pos.x, "║");
+    paint_glyph(win, scr_pos.y - 2, scr_pos.x, final_pipe);
+    paint_glyph(win, scr_pos.y - 1, scr_pos.x, gl_path_v);
 }
 
 //! Commandtion analogous to \ref paint_up
 void paint_left(Witness* wc, WINDOW* win, coord c, Dir point)
 {
     VERIFY_PAINT_CONDITIONS(wc, c, dir_left, point);
-    char const* final_pipe = NULL;
+    Glyph final_pipe = GLYPH_COUNT;
 
     switch (point) {
-        case dir_up: final_pipe = "╚"; break;
+        case dir_up: final_pipe = gl_path_up_right; break;
         case dir_left:
             if (c.y == 0) {
-                final_pipe = "╤";
+                final_pipe = gl_path_h_down;
                 break;
             }
-            final_pipe = (c.y == wc->height) ? "╧" : "╪";
+            final_pipe = (c.y == wc->height) ? gl_path_h_up : gl_path_h_cross;
             break;
-        case dir_down: final_pipe = "╔"; break;
+        case dir_down: final_pipe = gl_path_down_right; break;
         default:
             log_and_exit("Invalid point direction in %s, aborting...\n",
                          __func__);
@@ -454,28 +551,28 @@ void paint_left(Witness* wc, WINDOW* win, coord c, Dir point)
 
     coord scr_pos = get_scr_pos(c);
 
-    mvwaddstr(win, scr_pos.y, scr_pos.x - 1, "═");
-    mvwaddstr(win, scr_pos.y, scr_pos.x - 2, "═");
-    mvwaddstr(win, scr_pos.y, scr_pos.x - 3, "═");
-    mvwaddstr(win, scr_pos.y, scr_pos.x - 4, final_pipe);
+    paint_glyph(win, scr_pos.y, scr_pos.x - 1, gl_path_h);
+    paint_glyph(win, scr_pos.y, scr_pos.x - 2, gl_path_h);
+    paint_glyph(win, scr_pos.y, scr_pos.x - 3, gl_path_h);
+    paint_glyph(win, scr_pos.y, scr_pos.x - 4, final_pipe);
 }
 
 //! Commandtion analogous to \ref paint_up
 void paint_right(Witness* wc, WINDOW* win, coord c, Dir point)
 {
     VERIFY_PAINT_CONDITIONS(wc, c, dir_right, point);
-    char const* final_pipe = NULL;
+    Glyph final_pipe = GLYPH_COUNT;
 
     switch (point) {
-        case dir_up: final_pipe = "╝"; break;
+        case dir_up: final_pipe = gl_path_up_left; break;
         case dir_right:
             if (c.y == 0) {
-                final_pipe = "╤";
+                final_pipe = gl_path_h_down;
                 break;
             }
-            final_pipe = (c.y == wc->height) ? "╧" : "╪";
+            final_pipe = (c.y == wc->height) ? gl_path_h_up : gl_path_h_cross;
             break;
-        case dir_down: final_pipe = "╗"; break;
+        case dir_down: final_pipe = gl_path_down_left; break;
         default:
             log_and_exit("Invalid point direction in %s, aborting...\n",
                          __func__);
@@ -483,10 +580,10 @@ void paint_right(Witness* wc, WINDOW* win, coord c, Dir point)
 
     coord scr_pos = get_scr_pos(c);
 
-    mvwaddstr(win, scr_pos.y, scr_pos.x + 1, "═");
-    mvwaddstr(win, scr_pos.y, scr_pos.x + 2, "═");
-    mvwaddstr(win, scr_pos.y, scr_pos.x + 3, "═");
-    mvwaddstr(win, scr_pos.y, scr_pos.x + 4, final_pipe);
+    paint_glyph(win, scr_pos.y, scr_pos.x + 1, gl_path_h);
+    paint_glyph(win, scr_pos.y, scr_pos.x + 2, gl_path_h);
+    paint_glyph(win, scr_pos.y, scr_pos.x + 3, gl_path_h);
+    paint_glyph(win, scr_pos.y, scr_pos.x + 4, final_pipe);
 }
 
 //! Commandtion analogous to \ref paint_up
@@ -494,17 +591,17 @@ void paint_down(Witness* wc, WINDOW* win, coord c, Dir point)
 {
     VERIFY_PAINT_CONDITIONS(wc, c, dir_down, point);
 
-    char const* final_pipe = NULL;
+    Glyph final_pipe = GLYPH_COUNT;
     switch (point) {
         case dir_down:
             if (c.x == wc->width) {
-                final_pipe = "╢";
+                final_pipe = gl_path_v_left;
                 break;
             }
-            final_pipe = (c.x == 0) ? "╟" : "╫";
+            final_pipe = (c.x == 0) ? gl_path_v_right : gl_path_v_cross;
             break;
-        case dir_left : final_pipe = "╝"; break;
-        case dir_right: final_pipe = "╚"; break;
+        case dir_left : final_pipe = gl_path_up_left; break;
+        case dir_right: final_pipe = gl_path_up_right; break;
         default:
             log_and_exit("Invalid point direction in %s, aborting...\n",
                          __func__);
@@ -512,8 +609,8 @@ void paint_down(Witness* wc, WINDOW* win, coord c, Dir point)
 
     coord scr_pos = get_scr_pos(c);
 
-    mvwaddstr(win, scr_pos.y + 2, scr_pos.x, final_pipe);
-    mvwaddstr(win, scr_pos.y + 1, scr_pos.x, "║");
+    paint_glyph(win, scr_pos.y + 2, scr_pos.x, final_pipe);
+    paint_glyph(win, scr_pos.y + 1, scr_pos.x, gl_path_v);
 }
 
 /*!
@@ -547,19 +644,23 @@ void paint_last(Witness* wc, WINDOW* win)
     coord scr_pos = get_scr_pos(v.data[v.sz - 2]);
     Dir move      = get_direction(v.data[v.sz - 2], v.data[v.sz - 1]);
     switch (move) {
-        case dir_up: mvwaddstr(win, scr_pos.y - 1, scr_pos.x, "║"); break;
+        case dir_up:
+            paint_glyph(win, scr_pos.y - 1, scr_pos.x, gl_path_v);
+            break;
         case dir_left:
-            mvwaddstr(win, scr_pos.y, scr_pos.x - 1, "═");
-            mvwaddstr(win, scr_pos.y, scr_pos.x - 2, "═");
-            mvwaddstr(win, scr_pos.y, scr_pos.x - 3, "═");
+            paint_glyph(win, scr_pos.y, scr_pos.x - 1, gl_path_h);
+            paint_glyph(win, scr_pos.y, scr_pos.x - 2, gl_path_h);
+            paint_glyph(win, scr_pos.y, scr_pos.x - 3, gl_path_h);
             break;
         case dir_right:
-            mvwaddstr(win, scr_pos.y, scr_pos.x + 1, "═");
-            mvwaddstr(win, scr_pos.y, scr_pos.x + 2, "═");
-            mvwaddstr(win, scr_pos.y, scr_pos.x + 3, "═");
+            paint_glyph(win, scr_pos.y, scr_pos.x + 1, gl_path_h);
+            paint_glyph(win, scr_pos.y, scr_pos.x + 2, gl_path_h);
+            paint_glyph(win, scr_pos.y, scr_pos.x + 3, gl_path_h);
             break;
-        case dir_down: mvwaddstr(win, scr_pos.y + 1, scr_pos.x, "║"); break;
-        default      : assert(false);
+        case dir_down:
+            paint_glyph(win, scr_pos.y + 1, scr_pos.x, gl_path_v);
+            break;
+        default: assert(false);
     }
 }
 
@@ -683,71 +784,87 @@ void backtrack(Witness* wc)
     VEC_POP(&wc->pos);
 }
 
+/*!
+ * \brief Moves the player one step in a direction
+ *
+ * Stepping back onto the path backtracks, and steps outside the grid or onto
+ * junctions already visited are ignored.
+ *
+ * \param[in,out] wc The witness puzzle the player moves in
+ * \param[in] action One of the directions, see \ref is_direction
+ */
+static void walk(Witness* wc, Action action)
+{
+    Dir next_dir = 0;
+    switch (action) {
+        case act_up   : next_dir = dir_up; break;
+        case act_left : next_dir = dir_left; break;
+        case act_down : next_dir = dir_down; break;
+        case act_right: next_dir = dir_right; break;
+        default:
+            log_and_exit("Non-direction passed to %s\n", __func__);
+    }
+
+    if (is_backtrack(wc, next_dir)) { backtrack(wc); }
+    else {
+        coord next = step(VEC_BACK(wc->pos), next_dir);
+        //Guard against stepping outside the grid and
+        //walking over already visited junctions
+        if (wit_coord_valid_grid(wc, next) && !VEC_CONTAINS(wc->pos, next)) {
+            set_walls(wc, next_dir, we_filled);
+            VEC_PUSH(&wc->pos, next);
+        }
+    }
+}
+
 /*!
  * \brief
  *
  * \param[in,out] this A pointer to a \ref Witness_command to play
+ * \param[in,out] ctx The context of the session playing
  *
- * \returns The Command \ref func_pop "popped" of the top of the \ref func_stack
+ * \returns The Command \ref pop_command "popped" of the top of the command
+ * stack of ctx
  */
-Command* play_witness(Witness* this)
+Command* play_witness(Witness* this, Context* ctx)
 {
     Witness* wc = this;
     WINDOW* win = create_witness_win(wc);
     paint_witness_board(wc, win);
-    wrefresh(win);
+    stage_window(win);
 
     while (!witness_is_solved(wc)) {
-        int ch = wgetch(win);
-
-        Dir next_dir = 0;
-        bool move    = false;
-        switch (ch) {
-            case KEY_UP:
-                move     = true;
-                next_dir = dir_up;
-                break;
-            case KEY_LEFT:
-                move     = true;
-                next_dir = dir_left;
-                break;
-            case KEY_DOWN:
-                move     = true;
-                next_dir = dir_down;
-                break;
-            case KEY_RIGHT:
-                move     = true;
-                next_dir = dir_right;
-                break;
-            //TODO: Add space -> backtrack
-            default:;
-        }
-
-        if (move) {
-            if (is_backtrack(wc, next_dir)) { backtrack(wc); }
-            else {
-                coord next = step(VEC_BACK(wc->pos), next_dir);
-                //Guard against stepping outside the grid and
-                //walking over already visited junctions
-                if (wit_coord_valid_grid(wc, next) &&
-                    !VEC_CONTAINS(wc->pos, next)) {
-                    set_walls(wc, next_dir, we_filled);
-                    VEC_PUSH(&wc->pos, next);
-                }
+        Input_event in = read_input(ctx, win);
+        if (in.action == act_resize) {
+            int const ht = 1 + 2 * wc->height;
+            int const wd = 1 + 4 * wc->width;
+            // A window cut off by a smaller screen lost what was cut off
+            if (move_window(win, ht, wd, (LINES - ht) / 2, (COLS - wd) / 2)) {
+                paint_witness_board(wc, win);
+                paint_path(wc, win, col_yellow);
+                stage_window(win);
             }
-            //Update screen
-            paint_witness_board(wc, win);
-            paint_path(wc, win, col_yellow);
-            wrefresh(win);
+            continue;
         }
+        //TODO: Add space -> backtrack
+        if (!is_direction(in.action)) { continue; }
+
+        // Directions queued up behind in are walked before the board is drawn
+        do {
+            walk(wc, in.action);
+        } while (!witness_is_solved(wc) &&
+                 read_queued_input(win, is_direction_input, &in));
+
+        //Update screen
+        paint_witness_board(wc, win);
+        paint_path(wc, win, col_yellow);
+        stage_window(win);
     }
 
 
-    werase(win);
-    wrefresh(win);
-    delwin(win);
+    release_window(win);
 
-    return pop_command(NULL);
+    return pop_command(NULL, ctx);
 }
 
 void test_play_witness(void)
@@ -777,7 +894,9 @@ void test_play_witness(void)
     };
     VEC_PUSH(&test_wc.pos, ((coord){0, 0}));
 
-    play_witness(&test_wc);
+    Context ctx = {0};
+    play_witness(&test_wc, &ctx);
+    free_vec(&test_wc.pos);
 
     //NOLINTEND
 }
@@ -67,4 +67,4 @@ typedef struct Witness
 } Witness;
 
 //! Play a witness game specified by this
-Command* play_witness(Witness* this);
+Command* play_witness(Witness* this, Context* ctx);
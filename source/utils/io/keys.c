@@ -0,0 +1,242 @@
+/*!
+ * \file keys.c
+ * \brief Implementation file to \ref keys.h
+ *
+ * The bindings are a table with an entry for every key wgetch can return, so
+ * looking an action up is indexing an array.
+ *
+ * A file of bindings has one binding per line: the name of an action followed
+ * by the name of a key as given by keyname, e.g. "up k", "select ^M" or "last
+ * KEY_END". Empty lines and lines starting with '#' are skipped.
+ */
+
+#include <assert.h>
+#include <ncurses.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "keys.h"
+#include "logging.h"
+#include "utf8.h"
+
+enum
+{
+    ASCII_BS  = 8,
+    ASCII_LF  = 10,
+    ASCII_CR  = 13,
+    ASCII_ESC = 27,
+    ASCII_DEL = 127,
+    //! Longest line of a bindings file
+    BINDING_LINE_MAX = 128
+};
+
+//! \cond
+#define DEFAULT_BINDINGS                                                       \
+    {                                                                          \
+        [KEY_UP] = act_up, ['w'] = act_up, ['W'] = act_up,                     \
+        [KEY_DOWN] = act_down, ['s'] = act_down, ['S'] = act_down,             \
+        [KEY_LEFT] = act_left, ['a'] = act_left, ['A'] = act_left,             \
+        [KEY_RIGHT] = act_right, ['d'] = act_right, ['D'] = act_right,         \
+        [KEY_PPAGE] = act_page_up, [KEY_NPAGE] = act_page_down,                \
+        [KEY_HOME] = act_first, [KEY_END] = act_last,                          \
+        [ASCII_CR] = act_select, [ASCII_LF] = act_select,                      \
+        [KEY_ENTER] = act_select, [KEY_BACKSPACE] = act_erase,                 \
+        [ASCII_BS] = act_erase, [ASCII_DEL] = act_erase,                       \
+        [ASCII_ESC] = act_escape, [KEY_RESIZE] = act_resize                    \
+    }
+//! \endcond
+
+//NOLINTBEGIN
+static Action const default_bindings[KEY_MAX + 1] = DEFAULT_BINDINGS;
+static Action bindings[KEY_MAX + 1]               = DEFAULT_BINDINGS;
+
+static Global_key_handler global_keys[ACTION_COUNT];
+
+static char const* const action_names[ACTION_COUNT] = {
+    [act_none] = "none",           [act_up] = "up",
+    [act_down] = "down",           [act_left] = "left",
+    [act_right] = "right",         [act_page_up] = "page_up",
+    [act_page_down] = "page_down", [act_first] = "first",
+    [act_last] = "last",           [act_select] = "select",
+    [act_erase] = "erase",         [act_escape] = "escape",
+    [act_resize] = "resize"};
+//NOLINTEND
+
+static unsigned long long now_ns(void)
+{
+    struct timespec t;
+    (void)clock_gettime(CLOCK_MONOTONIC, &t);
+    return (unsigned long long)t.tv_sec * 1000000000ULL +
+           (unsigned long long)t.tv_nsec;
+}
+
+Action key_action(int key)
+{
+    return key >= 0 && key <= KEY_MAX ? bindings[key] : act_none;
+}
+
+void bind_key(int key, Action action)
+{
+    assert(key >= 0 && key <= KEY_MAX && action < ACTION_COUNT);
+    bindings[key] = action;
+}
+
+void reset_key_bindings(void)
+{
+    memcpy(bindings, default_bindings, sizeof bindings);
+}
+
+//! Returns the action named name, or ACTION_COUNT if there is none
+static Action find_action(char const* name)
+{
+    for (int i = 0; i < ACTION_COUNT; ++i) {
+        if (strcmp(action_names[i], name) == 0) { return (Action)i; }
+    }
+    return ACTION_COUNT;
+}
+
+//! Returns the key keyname calls name, or ERR if there is none
+static int find_key(char const* name)
+{
+    for (int key = 0; key <= KEY_MAX; ++key) {
+        char const* curr = keyname(key);
+        if (curr && strcmp(curr, name) == 0) { return key; }
+    }
+    return ERR;
+}
+
+/*!
+ * Lines that can't be read are logged and skipped, the other lines are bound
+ * either way. Key names are those of the terminal, so ncurses has to be set
+ * up first.
+ *
+ * \param[in] path The file of bindings, see \ref keys.c for its format
+ *
+ * \returns false if the file couldn't be opened or a line couldn't be read
+ */
+bool load_key_bindings(char const* path)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        log_msgf("Failed to open the key bindings '%s'\n", path);
+        return false;
+    }
+
+    bool ok = true;
+    char line[BINDING_LINE_MAX];
+    for (int n = 1; fgets(line, sizeof line, f); ++n) {
+        char action_name[BINDING_LINE_MAX];
+        char key_name[BINDING_LINE_MAX];
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0') {
+            continue;
+        }
+
+        Action action = ACTION_COUNT;
+        int key       = ERR;
+        if (sscanf(line, "%127s %127s", action_name, key_name) == 2) {
+            action = find_action(action_name);
+            key    = find_key(key_name);
+        }
+        if (action == ACTION_COUNT || key == ERR) {
+            log_msgf("Skipped line %d of the key bindings '%s'\n", n, path);
+            ok = false;
+            continue;
+        }
+        bindings[key] = action;
+    }
+
+    (void)fclose(f);
+    return ok;
+}
+
+void set_global_key(Action action, Global_key_handler handler)
+{
+    assert(action < ACTION_COUNT);
+    global_keys[action] = handler;
+}
+
+/*!
+ * \brief Has the global key handler of event, if any, handle it for ctx
+ *
+ * A handler reads keys of its own, which aren't handled globally. The
+ * checkpoint of ctx is put aside while the handler runs, since it restarts
+ * the loop that read event and not the handler.
+ *
+ * \returns true if event was handled
+ */
+static bool handle_globally(Context* ctx, Input_event const* event)
+{
+    Global_key_handler const handler = global_keys[event->action];
+    if (!handler || ctx->in_global_key) { return false; }
+
+    Command* const checkpoint = ctx->checkpoint;
+    ctx->checkpoint           = NULL;
+    ctx->in_global_key        = true;
+    bool const handled        = handler(event);
+    ctx->in_global_key        = false;
+    ctx->checkpoint           = checkpoint;
+    return handled;
+}
+
+/*!
+ * Every key read is stamped with the time it was read, and looked up in the
+ * bindings. Keys handled globally are not returned; the next key is read
+ * instead.
+ *
+ * \param[in,out] ctx The context of the session reading
+ * \param[in] win The window to read from
+ *
+ * \returns The key read
+ */
+Input_event read_input(Context* ctx, WINDOW* win)
+{
+    while (true) {
+        int const key     = read_key(win);
+        Input_event event = {key, key_action(key), now_ns()};
+        if (!handle_globally(ctx, &event)) { return event; }
+    }
+}
+
+/*!
+ * Loops use this to catch up with keys that piled up while they were drawing,
+ * e.g. when an arrow key is held down on a slow connection: they apply every
+ * wanted key queued up and only then draw, once. A key that isn't wanted is
+ * put back to be read next.
+ *
+ * Since reading a key refreshes the window read from, it has to be called
+ * before anything is drawn on win. Unlike \ref read_input it doesn't block,
+ * doesn't start a new frame and doesn't handle global keys.
+ *
+ * \param[in] win The window to read from
+ * \param[in] wanted Returns whether a key, with its action, should be taken
+ * \param[out] event The key taken, left as it is if none is
+ *
+ * \returns false if no wanted key was queued
+ */
+bool read_queued_input(WINDOW* win, bool (*wanted)(Input_event const* event),
+                       Input_event* event)
+{
+    int const key = read_waiting_key(win);
+    if (key == ERR) { return false; }
+
+    Input_event const queued = {key, key_action(key), now_ns()};
+    if (!wanted(&queued)) {
+        ungetch(key);
+        return false;
+    }
+    *event = queued;
+    return true;
+}
+
+bool is_direction(Action action)
+{
+    return action == act_up || action == act_down || action == act_left ||
+           action == act_right;
+}
+
+bool is_direction_input(Input_event const* event)
+{
+    return is_direction(event->action);
+}
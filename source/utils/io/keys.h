@@ -0,0 +1,89 @@
+/*!
+ * \file keys.h
+ *
+ * \brief Reading keys as the actions they are bound to
+ *
+ * Interactive loops don't look at keys but at what they are bound to, an \ref
+ * Action, which is found in a table indexed by the key. The bindings can be
+ * changed, e.g. from a file of the player's with \ref load_key_bindings, and
+ * some actions can be handled globally, whichever loop is reading keys, see
+ * \ref set_global_key.
+ */
+
+#pragma once
+
+#include <ncurses.h>
+#include <stdbool.h>
+
+#include "base.h"
+
+//! What a key does
+typedef enum Action
+{
+    act_none,
+    act_up,
+    act_down,
+    act_left,
+    act_right,
+    act_page_up,
+    act_page_down,
+    act_first,
+    act_last,
+    act_select,
+    act_erase,
+    act_escape,
+    //! The screen was resized, and what is shown should be moved to fit it
+    act_resize,
+    ACTION_COUNT
+} Action;
+
+//! A key read, together with its action and when it was read
+typedef struct Input_event
+{
+    //! The key as returned by wgetch
+    int key;
+    Action action;
+    //! When the key was read, in nanoseconds of CLOCK_MONOTONIC
+    unsigned long long read_ns;
+} Input_event;
+
+/*!
+ * \brief Function handling an action wherever it is read, see \ref
+ * set_global_key
+ *
+ * Returns true if it handled event, which is then not passed on to the loop
+ * that read it. What it shows on windows from \ref take_window is drawn over
+ * the screen, which is as it was once they are released, so that the loop
+ * doesn't need to know.
+ */
+typedef bool (*Global_key_handler)(Input_event const* event);
+
+//! Returns the action key is bound to
+Action key_action(int key);
+
+//! Binds key to action, where act_none unbinds it
+void bind_key(int key, Action action);
+
+//! Restores the bindings every key has by default
+void reset_key_bindings(void);
+
+//! Binds the keys listed in the file at path, see \ref keys.c
+bool load_key_bindings(char const* path);
+
+//! Has handler handle action before any loop gets it (NULL stops it)
+void set_global_key(Action action, Global_key_handler handler);
+
+//! Reads a key from win for the session ctx like \ref read_key, and
+//! dispatches it
+Input_event read_input(Context* ctx, WINDOW* win);
+
+//! Reads the next key from win if it is already queued up and wanted
+bool read_queued_input(WINDOW* win, bool (*wanted)(Input_event const* event),
+                       Input_event* event);
+
+//! Checks if action is one of the four directions
+bool is_direction(Action action);
+
+//! Checks if the action of event is one of the four directions, see \ref
+//! read_queued_input
+bool is_direction_input(Input_event const* event);
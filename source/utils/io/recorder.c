@@ -0,0 +1,332 @@
+/*!
+ * \file recorder.c
+ * \brief Implementation file to \ref recorder.h
+ *
+ * \ref record_output appends the bytes and their time to the recording's
+ * events in memory, under a lock held for no longer than a copy. A single
+ * writer thread takes the events of every recording whenever enough have
+ * piled up, or every \ref FLUSH_INTERVAL_MS, and escapes them into JSON lines
+ * outside of the lock. A recording whose writer can't keep up drops output
+ * rather than slowing down the terminal being recorded.
+ *
+ * The writer never logs through \ref log_msgf or exits with \ref
+ * log_and_exit: the log stream can be changed by the thread running the
+ * sessions, and exiting would pull the process from under it. It reports to
+ * stderr directly, which stdio locks, and a recording it runs out of memory
+ * for loses the output instead.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "logging.h"
+#include "recorder.h"
+
+enum
+{
+    //! The writer wakes up at least this often
+    FLUSH_INTERVAL_MS = 200,
+    //! Bytes recorded that wake the writer up early
+    FLUSH_THRESHOLD = 64 * 1024,
+    //! Bytes a recording may hold in memory before output is dropped
+    MAX_BACKLOG     = 16 * 1024 * 1024,
+    FILE_BUFFER_SZ  = 64 * 1024,
+    MAX_UTF8_LEN    = 4
+};
+
+//! Growable byte buffer
+typedef struct Byte_buffer
+{
+    char* data;
+    size_t len;
+    size_t cap;
+} Byte_buffer;
+
+//! Precedes the bytes of every event in \ref Recorder::events
+typedef struct Event_header
+{
+    unsigned long long ns;
+    size_t len;
+} Event_header;
+
+struct Recorder
+{
+    FILE* file;
+    unsigned long long start_ns;
+    //! Events not yet taken by the writer, guarded by \ref lock
+    Byte_buffer events;
+    //! Set by \ref stop_recording, guarded by \ref lock
+    bool stopped;
+    //! Bytes dropped because the writer fell behind, guarded by \ref lock
+    size_t dropped;
+    //! Bytes the writer had no memory to write, only used by the writer
+    size_t lost;
+    //! Start of a UTF-8 character cut off at the end of the last event
+    char carry[MAX_UTF8_LEN];
+    size_t carry_len;
+    //! The recordings the writer looks after form a singly linked list
+    struct Recorder* next;
+};
+
+//NOLINTBEGIN
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake  = PTHREAD_COND_INITIALIZER;
+//! Every recording that hasn't been written out completely
+static Recorder* recorders = NULL;
+static bool writer_started = false;
+//NOLINTEND
+
+static unsigned long long now_ns(void)
+{
+    struct timespec t;
+    (void)clock_gettime(CLOCK_MONOTONIC, &t);
+    return (unsigned long long)t.tv_sec * 1000000000ULL +
+           (unsigned long long)t.tv_nsec;
+}
+
+//! Appends len bytes of data to b, returns false if out of memory
+static bool buffer_append(Byte_buffer* b, void const* data, size_t len)
+{
+    if (b->len + len > b->cap) {
+        size_t cap = b->cap ? b->cap : FILE_BUFFER_SZ;
+        while (cap < b->len + len) { cap *= 2; }
+        char* tmp = (char*)realloc(b->data, cap);
+        if (!tmp) { return false; }
+        b->data = tmp;
+        b->cap  = cap;
+    }
+    memcpy(b->data + b->len, data, len);
+    b->len += len;
+    return true;
+}
+
+//! Returns the length of the UTF-8 character starting with c, 0 if invalid
+static size_t utf8_len(unsigned char c)
+{
+    if (c < 0x80U) { return 1; }
+    if ((c & 0xE0U) == 0xC0U) { return 2; }
+    if ((c & 0xF0U) == 0xE0U) { return 3; }
+    if ((c & 0xF8U) == 0xF0U) { return 4; }
+    return 0;
+}
+
+static bool is_continuation(unsigned char c) { return (c & 0xC0U) == 0x80U; }
+
+//! Returns how many bytes at the end of data start a character left unfinished
+static size_t unfinished_tail(char const* data, size_t len)
+{
+    for (size_t i = 1; i < MAX_UTF8_LEN && i <= len; ++i) {
+        unsigned char const c = (unsigned char)data[len - i];
+        if (is_continuation(c)) { continue; }
+        return utf8_len(c) > i ? i : 0;
+    }
+    return 0;
+}
+
+/*!
+ * \brief Writes data as the contents of a JSON string
+ *
+ * Bytes that are not part of valid UTF-8 are written as the code point of the
+ * same value.
+ */
+static void write_json_chars(FILE* f, char const* data, size_t len)
+{
+    size_t i = 0;
+    while (i < len) {
+        unsigned char const c = (unsigned char)data[i];
+        if (c == '"' || c == '\\') {
+            (void)fputc('\\', f);
+            (void)fputc(c, f);
+            ++i;
+            continue;
+        }
+        if (c < 0x20U || c == 0x7FU) {
+            (void)fprintf(f, "\\u%04x", c);
+            ++i;
+            continue;
+        }
+
+        size_t n   = utf8_len(c);
+        bool valid = n > 0 && i + n <= len;
+        for (size_t j = 1; valid && j < n; ++j) {
+            valid = is_continuation((unsigned char)data[i + j]);
+        }
+        if (!valid) {
+            (void)fprintf(f, "\\u%04x", c);
+            ++i;
+            continue;
+        }
+        (void)fwrite(data + i, 1, n, f);
+        i += n;
+    }
+}
+
+//! Writes the events taken from a recording as asciicast output events
+static void write_events(Recorder* rec, Byte_buffer const* events,
+                         Byte_buffer* scratch)
+{
+    size_t at = 0;
+    while (at < events->len) {
+        Event_header h;
+        memcpy(&h, events->data + at, sizeof h);
+        at += sizeof h;
+
+        scratch->len = 0;
+        if (!buffer_append(scratch, rec->carry, rec->carry_len) ||
+            !buffer_append(scratch, events->data + at, h.len)) {
+            rec->lost += h.len;
+            at += h.len;
+            continue;
+        }
+        at += h.len;
+
+        rec->carry_len = unfinished_tail(scratch->data, scratch->len);
+        scratch->len -= rec->carry_len;
+        memcpy(rec->carry, scratch->data + scratch->len, rec->carry_len);
+        if (scratch->len == 0) { continue; }
+
+        (void)fprintf(rec->file, "[%.6f, \"o\", \"", (double)h.ns / 1e9);
+        write_json_chars(rec->file, scratch->data, scratch->len);
+        (void)fputs("\"]\n", rec->file);
+    }
+}
+
+static void finish_recording(Recorder* rec)
+{
+    if (rec->carry_len > 0) {
+        (void)fputs("[0, \"o\", \"", rec->file);
+        write_json_chars(rec->file, rec->carry, rec->carry_len);
+        (void)fputs("\"]\n", rec->file);
+    }
+    if (fclose(rec->file) != 0) {
+        (void)fputs("Failed to write a recording\n", stderr);
+    }
+    if (rec->dropped > 0) {
+        (void)fprintf(stderr, //NOLINT
+                      "A recording dropped %zu bytes it couldn't write in "
+                      "time\n",
+                      rec->dropped);
+    }
+    if (rec->lost > 0) {
+        (void)fprintf(stderr, //NOLINT
+                      "A recording lost %zu bytes for lack of memory\n",
+                      rec->lost);
+    }
+    free(rec->events.data);
+    free(rec);
+}
+
+//! Body of the writer thread, never returns
+static void* write_recordings(void* unused)
+{
+    (void)unused;
+    Byte_buffer taken   = {0};
+    Byte_buffer scratch = {0};
+
+    (void)pthread_mutex_lock(&lock);
+    while (true) {
+        struct timespec until;
+        (void)clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_nsec += FLUSH_INTERVAL_MS * 1000000L;
+        until.tv_sec += until.tv_nsec / 1000000000L;
+        until.tv_nsec %= 1000000000L;
+        (void)pthread_cond_timedwait(&wake, &lock, &until);
+
+        // Recordings are only ever unlinked here, so link stays valid while
+        // the lock is released
+        Recorder** link = &recorders;
+        while (*link) {
+            Recorder* rec = *link;
+            Byte_buffer const events = rec->events;
+            rec->events              = taken;
+            bool const stopped       = rec->stopped;
+            if (stopped) { *link = rec->next; }
+            else {
+                link = &rec->next;
+            }
+            (void)pthread_mutex_unlock(&lock);
+
+            write_events(rec, &events, &scratch);
+            taken     = events;
+            taken.len = 0;
+            if (stopped) { finish_recording(rec); }
+            else {
+                (void)fflush(rec->file);
+            }
+
+            (void)pthread_mutex_lock(&lock);
+        }
+    }
+
+    return NULL;
+}
+
+Recorder* start_recording(char const* path, int columns, int lines)
+{
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        log_msgf("Failed to create the recording '%s'\n", path);
+        return NULL;
+    }
+    (void)setvbuf(file, NULL, _IOFBF, FILE_BUFFER_SZ);
+
+    char const* term = getenv("TERM");
+    (void)fprintf(file,
+                  "{\"version\": 2, \"width\": %d, \"height\": %d, "
+                  "\"timestamp\": %lld, \"env\": {\"TERM\": \"",
+                  columns, lines, (long long)time(NULL));
+    write_json_chars(file, term ? term : "", term ? strlen(term) : 0);
+    (void)fputs("\"}}\n", file);
+
+    Recorder* rec = (Recorder*)calloc(1, sizeof(Recorder));
+    if (!rec) { log_and_exit("Out of memory in %s\n", __func__); }
+    rec->file     = file;
+    rec->start_ns = now_ns();
+
+    (void)pthread_mutex_lock(&lock);
+    if (!writer_started) {
+        pthread_t writer;
+        if (pthread_create(&writer, NULL, write_recordings, NULL) != 0) {
+            log_and_exit("Failed to start the recording writer\n");
+        }
+        (void)pthread_detach(writer);
+        writer_started = true;
+    }
+    rec->next = recorders;
+    recorders = rec;
+    (void)pthread_mutex_unlock(&lock);
+
+    return rec;
+}
+
+void record_output(Recorder* rec, char const* data, size_t len)
+{
+    if (len == 0) { return; }
+    Event_header const h = {.ns = now_ns() - rec->start_ns, .len = len};
+
+    (void)pthread_mutex_lock(&lock);
+    size_t const at = rec->events.len;
+    if (at + sizeof h + len > MAX_BACKLOG ||
+        !buffer_append(&rec->events, &h, sizeof h) ||
+        !buffer_append(&rec->events, data, len)) {
+        // A header without its bytes is taken back
+        rec->events.len = at;
+        rec->dropped += len;
+    }
+    else if (rec->events.len >= FLUSH_THRESHOLD) {
+        (void)pthread_cond_signal(&wake);
+    }
+    (void)pthread_mutex_unlock(&lock);
+}
+
+void stop_recording(Recorder* rec)
+{
+    (void)pthread_mutex_lock(&lock);
+    rec->stopped = true;
+    (void)pthread_cond_signal(&wake);
+    (void)pthread_mutex_unlock(&lock);
+}
@@ -0,0 +1,33 @@
+/*!
+ * \file recorder.h
+ *
+ * \brief Recording terminal output in the asciicast v2 format
+ *
+ * A recording holds the exact bytes written to a terminal, each with the time
+ * it was written, and can be replayed with asciinema. Recording only copies
+ * the bytes into memory; a background thread shared by all recordings formats
+ * and writes them to disk.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+typedef struct Recorder Recorder;
+
+/*!
+ * \brief Creates the file at path and starts recording into it
+ *
+ * \param[in] path Where to write the recording
+ * \param[in] columns The width of the terminal recorded
+ * \param[in] lines The height of the terminal recorded
+ *
+ * \returns The recorder, or NULL if the file could not be created
+ */
+Recorder* start_recording(char const* path, int columns, int lines);
+
+//! Records len bytes written to the terminal now
+void record_output(Recorder* rec, char const* data, size_t len);
+
+//! Ends a recording; what has been recorded is still written out afterwards
+void stop_recording(Recorder* rec);
@@ -14,12 +14,75 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <wchar.h>
 
+#include "accounting.h"
+#include "arena.h"
 #include "logging.h"
 #include "utf8.h"
+#include "window_pool.h"
 
 int load_utf8_tail(char* buf, Input inp);
 
+//! Called instead of blocking in \ref read_key when set
+static Input_wait input_wait = NULL; //NOLINT
+
+void set_input_wait(Input_wait wait) { input_wait = wait; }
+
+/*!
+ * Reads a key from win like wgetch, if one is available right away. It
+ * neither blocks nor starts a new frame like \ref read_key does.
+ *
+ * \param[in] win The window to read from
+ *
+ * \returns The key read, or ERR if none was available
+ */
+int read_waiting_key(WINDOW* win)
+{
+    wtimeout(win, 0);
+    int ch = wgetch(win);
+    wtimeout(win, -1);
+    return ch;
+}
+
+//! Calls \ref input_wait until a key can be read from win without blocking
+static int wait_for_key(WINDOW* win)
+{
+    while (true) {
+        int ch = read_waiting_key(win);
+        if (ch != ERR) { return ch; }
+
+        input_wait();
+    }
+}
+
+/*!
+ * Reads a key from a window like wgetch. If an \ref Input_wait has been set,
+ * it is called whenever no key is available rather than blocking the process.
+ *
+ * Every key starts a new frame: what was staged is drawn with \ref
+ * commit_frame and the \ref frame_arena is reset before waiting for it, and
+ * allocations are counted towards the new frame once it has been read (see
+ * \ref start_alloc_frame).
+ *
+ * KEY_RESIZE, which ncurses returns once it has resized the screen, has the
+ * whole screen drawn again, see \ref repaint_screen. Moving windows to fit is
+ * left to the loop reading keys.
+ *
+ * \param[in] win The window to read from
+ *
+ * \returns The key read, as returned by wgetch
+ */
+int read_key(WINDOW* win)
+{
+    commit_frame();
+    arena_reset(frame_arena());
+    int ch = input_wait ? wait_for_key(win) : wgetch(win);
+    start_alloc_frame();
+    if (ch == KEY_RESIZE) { repaint_screen(); }
+    return ch;
+}
+
 //! Checks if the passed in byte is an ASCII character
 static inline bool is_ascii(unsigned int c)
 {
@@ -86,22 +149,25 @@ int get_input_char(Input i)
 {
     int res = -1;
     switch (i.tag) {
-        case tag_win: res = wgetch(i.win); break;
+        case tag_win: res = read_key(i.win); break;
         case tag_str: res = (unsigned char)*i.str; break;
     }
 
     return res;
 }
 
-void wait_press(Input i)
+int wait_press(Input i)
 {
     int ch = get_input_char(i);
     char buf[ASCII_BUF_SZ];
-    if (KEY_MIN <= ch && ch <= KEY_MAX) { return; }
+    if (KEY_MIN <= ch && ch <= KEY_MAX) { return ch; }
     else {
+        buf[0]  = (char)ch;
         int err = load_utf8_tail(buf, i);
-        if (err) { log_and_exit("Failed to read a character\n"); }
+        // Any key will do, so a malformed one is only worth a note
+        if (err) { log_msgf("Failed to read a character\n"); }
     }
+    return ch;
 }
 
 /*!
@@ -264,24 +330,37 @@ int floadw_utf8(char* buf, FILE* file)
 }
 
 /*!
- * Reads a UTF-8 character from the specified input source and returns a
- * malloced string containing it
+ * Reads a UTF-8 character from the specified input source and returns a string
+ * containing it, to be released with \ref tracked_free
+ *
+ * \param[in] win The \ref Input "input" from which to read the UTF-8 character
+ *
+ * \returns A pointer to the string on success, NULL on failure
+ */
+const char* get_utf8(Input inp) { return get_utf8_in(NULL, inp); }
+
+/*!
+ * Reads a UTF-8 character from the specified input source and returns a string
+ * containing it, allocated from arena
  *
+ * The character is read before anything is allocated, so the \ref
+ * frame_arena can be passed even though reading a key resets it.
+ *
+ * \param[in,out] arena The arena to allocate from, or NULL for the heap
  * \param[in] win The \ref Input "input" from which to read the UTF-8 character
  *
- * \returns A pointer to the malloced string on success, NULL on failure
+ * \returns A pointer to the string on success, NULL on failure
  */
-const char* get_utf8(Input inp)
+const char* get_utf8_in(Arena* arena, Input inp)
 {
     // A unicode character can be 1-4 bytes + null termination
-    char* res = (char*)malloc(ASCII_BUF_SZ);
-
-    int err = load_utf8(res, inp);
+    char buf[ASCII_BUF_SZ];
+    if (load_utf8(buf, inp) != 0) { return NULL; }
 
-    if (err != 0) {
-        free(res);
-        return NULL;
-    }
+    size_t const len = strlen(buf) + 1;
+    char* res = arena ? (char*)arena_alloc(arena, len)
+                      : (char*)tracked_malloc(sub_utf8, len);
+    memcpy(res, buf, len);
 
     return res;
 }
@@ -303,3 +382,65 @@ int utf8_strlen(const char* str)
     }
     return count;
 }
+
+/*!
+ * Returns how many of the first len bytes of str make up whole UTF-8
+ * characters, i.e. len unless the last character has been cut off
+ */
+int utf8_complete_len(char const* str, int len)
+{
+    int start = len;
+    while (start > 0 && is_continuation((unsigned char)str[start - 1])) {
+        --start;
+    }
+    if (start == 0) { return 0; }
+
+    int const char_len = get_utf8_len((unsigned char)str[start - 1]);
+    return char_len > len - start + 1 ? start - 1 : len;
+}
+
+/*!
+ * \brief Converts a UTF-8 string into cells of the screen
+ *
+ * Painting cells with mvwadd_wchnstr or mvwadd_wch skips the decoding that
+ * mvwaddstr does every time it is called, so text painted over and over, like
+ * art and labels, is converted once, when it is loaded.
+ *
+ * \param[in] str The string to convert
+ * \param[in] bytes The number of bytes of str to convert, all if negative
+ * \param[in] attr The attributes of every cell
+ * \param[out] cells Room for a cell per unicode code point of str, and the
+ * empty cell ending them
+ *
+ * \returns The number of cells, not counting the empty one
+ */
+int utf8_to_cells(char const* str, int bytes, attr_t attr, cchar_t* cells)
+{
+    unsigned int const tail_bits = 6;
+    unsigned int const tail_mask = 63;
+    // The bits of the first byte left by a code point of 1-4 bytes
+    unsigned int const lead_masks[] = {0, 127, 31, 15, 7};
+
+    int count = 0;
+    for (int i = 0; bytes < 0 ? str[i] != '\0' : i < bytes; ++count) {
+        unsigned int const lead = (unsigned char)str[i];
+        int const len           = get_utf8_len(lead);
+        if (len < 0) {
+            log_and_exit("Invalid UTF-8 byte %#x in %s\n", lead, __func__);
+        }
+
+        wchar_t wc = (wchar_t)(lead & lead_masks[len]);
+        for (int j = 1; j < len; ++j) {
+            wc = (wchar_t)(((unsigned int)wc << tail_bits) |
+                           ((unsigned char)str[i + j] & tail_mask));
+        }
+        i += len;
+
+        wchar_t const chars[] = {wc, L'\0'};
+        setcchar(&cells[count], chars, attr, 0, NULL);
+    }
+
+    wchar_t const empty[] = {L'\0'};
+    setcchar(&cells[count], empty, A_NORMAL, 0, NULL);
+    return count;
+}
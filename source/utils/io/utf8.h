@@ -12,6 +12,8 @@
 #include <stdbool.h>
 #include <stdio.h>
 
+struct Arena;
+
 enum
 {
     ASCII_MAX = 127,
@@ -35,15 +37,37 @@ typedef struct Input
     } tag;
 } Input;
 
+/*!
+ * \brief Function called when a key is needed but none is available yet
+ *
+ * Hosts running several sessions in one process use this to hand control back
+ * to their event loop instead of blocking. It should return once input might
+ * be available.
+ */
+typedef void (*Input_wait)(void);
+
+//! Makes \ref read_key call wait instead of blocking (NULL restores blocking)
+void set_input_wait(Input_wait wait);
+
+//! Reads a key from win, see \ref set_input_wait and \ref frame_arena
+int read_key(WINDOW* win);
+
+//! Reads a key from win if one is available without waiting
+int read_waiting_key(WINDOW* win);
+
 //! Interactive get input
 const char* get_input_utf8(Input inp);
 
 //! Interactive get input
 int get_input_char(Input inp);
 
-//! Reads a UTF-8 unicode point from inp and returns it as a malloced string
+//! Reads a UTF-8 unicode point from inp and returns it as a string to be
+//! released with \ref tracked_free
 const char* get_utf8(Input inp);
 
+//! Like \ref get_utf8, but allocates from arena unless it is NULL
+const char* get_utf8_in(struct Arena* arena, Input inp);
+
 //! Reads a UTF-8 unicode point from inp into buf
 int load_utf8(char* buf, Input inp);
 
@@ -56,5 +80,13 @@ int floadw_utf8(char* buf, FILE* file);
 //! Returns the length of a UTF-8 string in unicode code points
 int utf8_strlen(const char* str);
 
-//! Waits for (and discards) a keypress from input source
-void wait_press(Input i);
+//! Returns the bytes of str up to len that form complete UTF-8 characters
+int utf8_complete_len(char const* str, int len);
+
+//! Converts bytes of str into cells to paint with mvwadd_wchnstr, returns how
+//! many
+int utf8_to_cells(char const* str, int bytes, attr_t attr, cchar_t* cells);
+
+//! Waits for (and discards) a keypress from input source, returns its first
+//! byte, or the key if it isn't a character
+int wait_press(Input i);
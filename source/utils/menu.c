@@ -8,6 +8,7 @@
  */
 #include <assert.h>
 #include <ctype.h>
+#include <dirent.h>
 #include <errno.h>
 #include <limits.h>
 #include <ncurses.h>
@@ -18,16 +19,24 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "accounting.h"
+#include "arena.h"
 #include "base.h"
 #include "build-path.h"
+#include "io/keys.h"
 #include "io/logging.h"
 #include "io/utf8.h"
 #include "menu.h"
+#include "window_pool.h"
 
 enum
 {
-    LINE_FEED         = 13,
-    MAX_UTF8_WORD_LEN = 40
+    MAX_UTF8_WORD_LEN = 40,
+    //! Most choices \ref quick_print_menu can show
+    QUICK_MENU_MAX_CHOICES = 8,
+    //! Most bytes that can be typed to filter a menu
+    MENU_FILTER_MAX_LEN = 64,
+    ASCII_DEL           = 127
 };
 
 const char selection_string[] = u8"◇ ";
@@ -35,15 +44,67 @@ const char selection_string[] = u8"◇ ";
 int const selection_offset      = 2;
 int const menu_box_width_offset = 2 + selection_offset;
 
+//! When set, menus ask this function for a choice instead of reading keys
+static Menu_selector menu_selector = NULL; //NOLINT
+
+//! A dialogue file read into memory by \ref preload_dialogues
+typedef struct Dialogue
+{
+    char* path;
+    char* text;
+    size_t len;
+} Dialogue;
+
+/*!
+ * \brief A banner painted on a pad, see \ref banner_pad
+ *
+ * Banners are told apart by their art, which is static, and pads belong to
+ * the SCREEN they were created on, which is told apart by its stdscr.
+ */
+typedef struct Banner_pad
+{
+    void const* art;
+    WINDOW* screen;
+    WINDOW* pad;
+} Banner_pad;
+
+/*!
+ * \brief The art of a banner converted to cells, see \ref banner_cells
+ *
+ * Unlike pads, cells don't belong to a SCREEN, so the art is converted once
+ * for every session of the program.
+ */
+typedef struct Banner_cells
+{
+    void const* art;
+    int height;
+    //! A line of cells per line of art, each ended by an empty cell
+    cchar_t const* const* lines;
+} Banner_cells;
+
+//NOLINTBEGIN
+static Dialogue* dialogues = NULL;
+static int dialogues_len   = 0;
+
+static Banner_pad* banner_pads = NULL;
+static int banner_pads_len     = 0;
+
+static Banner_cells* banner_cells_cache = NULL;
+static int banner_cells_len             = 0;
+//NOLINTEND
+
+void set_menu_selector(Menu_selector selector) { menu_selector = selector; }
+
 /*!
  * \param[in] menu The menu to print
  * \param[in] highlight The \ref Menu_command::highlight value
  *
- * \returns A malloced Menu_command*
+ * \returns A Menu_command* from \ref tracked_malloc
  */
 Command* new_menu_command(Menu const* menu, int highlight)
 {
-    Menu_command* res = (Menu_command*)malloc(sizeof(Menu_command));
+    Menu_command* res =
+        (Menu_command*)tracked_malloc(sub_menu, sizeof(Menu_command));
     res->command      = (Command){.execute = show_menu, .persistent = false};
     res->menu         = menu;
     res->highlight    = highlight;
@@ -76,9 +137,92 @@ Banner make_banner(char const* const* art, int height)
     return res;
 }
 
-void paint_banner(WINDOW* win, Banner b)
+//! Returns the art of b, packed or not, which tells banners apart, or NULL
+static void const* banner_art(Banner b)
+{
+    return b.packed ? (void const*)b.packed : (void const*)b.art;
+}
+
+/*!
+ * \brief Unpacks a line of art into cells
+ *
+ * \param[in] art The art the line is from
+ * \param[in,out] codes The codes of the line, moved on to the next line
+ * \param[out] cells Room for the cells of the line, and the empty cell ending
+ * them
+ *
+ * \returns The number of cells, not counting the empty one
+ */
+static int unpack_line(Packed_art const* art, unsigned char const** codes,
+                       cchar_t* cells)
+{
+    unsigned char const* at = *codes;
+    int len                 = 0;
+    for (; *at != ART_LINE_END; ++at) {
+        int count = 1;
+        if (*at == ART_RUN) {
+            count = at[1];
+            at += 2;
+        }
+
+        wchar_t const chars[] = {art->glyphs[*at], L'\0'};
+        for (int i = 0; i < count; ++i) {
+            setcchar(&cells[len++], chars, A_NORMAL, 0, NULL);
+        }
+    }
+    *codes = at + 1;
+
+    wchar_t const empty[] = {L'\0'};
+    setcchar(&cells[len], empty, A_NORMAL, 0, NULL);
+    return len;
+}
+
+//! Returns the lines of b as cells, unpacking or converting them the first time
+static cchar_t const* const* banner_cells(Banner b)
+{
+    for (int i = 0; i < banner_cells_len; ++i) {
+        if (banner_cells_cache[i].art == banner_art(b) &&
+            banner_cells_cache[i].height == b.dim.height) {
+            return banner_cells_cache[i].lines;
+        }
+    }
+
+    // A line has no more cells than the banner is wide, plus the empty one
+    size_t const pointers = sizeof(cchar_t*) * (size_t)b.dim.height;
+    size_t const cells =
+        sizeof(cchar_t) * (size_t)b.dim.height * (size_t)(b.dim.width + 1);
+    cchar_t** lines = (cchar_t**)tracked_malloc(sub_menu, pointers + cells);
+    cchar_t* at     = (cchar_t*)((char*)lines + pointers);
+
+    // Packed lines follow each other in the codes
+    unsigned char const* codes = b.packed ? b.packed->codes : NULL;
+    for (int i = 0; i < b.dim.height; ++i) {
+        lines[i] = at;
+        at += (b.packed ? unpack_line(b.packed, &codes, at)
+                        : utf8_to_cells(b.art[i], -1, A_NORMAL, at)) +
+              1;
+    }
+    assert((char*)at <= (char*)lines + pointers + cells);
+
+    banner_cells_cache = (Banner_cells*)tracked_realloc(
+        sub_menu, banner_cells_cache,
+        sizeof(Banner_cells) * (size_t)(banner_cells_len + 1));
+    banner_cells_cache[banner_cells_len++] = (Banner_cells){
+        banner_art(b), b.dim.height, (cchar_t const* const*)lines};
+    return (cchar_t const* const*)lines;
+}
+
+/*!
+ * The art is unpacked to cells the first time it is painted, by whichever
+ * scene shows it first, and only copied to win after that. Art that is never
+ * shown is never unpacked.
+ */
+void paint_banner(WINDOW* win, Banner b, int y, int x)
 {
-    for (int i = 0; i < b.dim.height; ++i) { mvwaddstr(win, i, 0, b.art[i]); }
+    cchar_t const* const* lines = banner_cells(b);
+    for (int i = 0; i < b.dim.height; ++i) {
+        mvwadd_wchnstr(win, y + i, x, lines[i], -1);
+    }
 }
 
 /*!
@@ -101,112 +245,525 @@ void get_dialogue_path(char* buf, int sz)
     strcat(buf, "/dialogue/");
 }
 
+static char* read_whole_file(char const* path, size_t* len)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) { return NULL; }
+
+    char* text = NULL;
+    long size  = -1;
+    if (fseek(f, 0, SEEK_END) == 0) { size = ftell(f); }
+    if (size > 0 && fseek(f, 0, SEEK_SET) == 0) {
+        text = (char*)tracked_malloc(sub_menu, (size_t)size);
+        if (fread(text, 1, (size_t)size, f) != (size_t)size) {
+            tracked_free(text);
+            text = NULL;
+        }
+    }
+    (void)fclose(f);
+
+    *len = (size_t)size;
+    return text;
+}
+
+/*!
+ * Reads every file of the dialogue directory into memory, after which
+ * dialogues are printed without touching the disk. A process forking sessions
+ * off should call this first, so that they all share the same copy.
+ */
+void preload_dialogues(void)
+{
+    char dir_path[PATH_MAX];
+    get_dialogue_path(dir_path, PATH_MAX);
+    DIR* dir = opendir(dir_path);
+    if (!dir) {
+        log_msgf("Failed to open the dialogue directory '%s'\n", dir_path);
+        return;
+    }
+
+    struct dirent* entry = NULL;
+    while ((entry = readdir(dir))) {
+        if (entry->d_name[0] == '.') { continue; }
+
+        char path[PATH_MAX];
+        int n = snprintf(path, sizeof path, "%s%s", dir_path, entry->d_name);
+        if (n < 0 || n >= (int)sizeof path) { continue; }
+
+        size_t len = 0;
+        char* text = read_whole_file(path, &len);
+        if (!text) { continue; }
+
+        dialogues = (Dialogue*)tracked_realloc(
+            sub_menu, dialogues,
+            sizeof(Dialogue) * (size_t)(dialogues_len + 1));
+        char* path_copy = (char*)tracked_malloc(sub_menu, (size_t)n + 1);
+        memcpy(path_copy, path, (size_t)n + 1);
+        dialogues[dialogues_len++] = (Dialogue){path_copy, text, len};
+    }
+    (void)closedir(dir);
+}
+
+//! Opens a dialogue for reading, from memory if it has been preloaded
+static FILE* open_dialogue(char const* path)
+{
+    for (int i = 0; i < dialogues_len; ++i) {
+        if (strcmp(dialogues[i].path, path) == 0) {
+            return fmemopen(dialogues[i].text, dialogues[i].len, "r");
+        }
+    }
+
+    return fopen(path, "r");
+}
+
+/*!
+ * \brief Returns the pad on which b has been painted, painting it first if it
+ * hasn't
+ *
+ * Banners are painted once per SCREEN, since some of them are kilobytes of
+ * UTF-8, and copied to the screen from their pads every time they are shown
+ * after that.
+ */
+static WINDOW* banner_pad(Banner b)
+{
+    for (int i = 0; i < banner_pads_len; ++i) {
+        if (banner_pads[i].art == banner_art(b) &&
+            banner_pads[i].screen == stdscr &&
+            getmaxy(banner_pads[i].pad) == b.dim.height) {
+            return banner_pads[i].pad;
+        }
+    }
+
+    WINDOW* pad = newpad(b.dim.height, b.dim.width);
+    if (!pad) { log_and_exit("Failed to create a pad in %s\n", __func__); }
+    paint_banner(pad, b, 0, 0);
+    banner_pads = (Banner_pad*)tracked_realloc(
+        sub_menu, banner_pads,
+        sizeof(Banner_pad) * (size_t)(banner_pads_len + 1));
+    banner_pads[banner_pads_len++] = (Banner_pad){banner_art(b), stdscr, pad};
+    return pad;
+}
+
+//! Shows b with its upper left corner at (y, x), see \ref hide_banner
+static void show_banner(Banner b, int y, int x)
+{
+    if (banner_art(b)) {
+        show_pad(banner_pad(b), y, x, b.dim.height, b.dim.width);
+    }
+}
+
+//! Takes a banner shown by \ref show_banner off the screen
+static void hide_banner(Banner b)
+{
+    if (banner_art(b)) { hide_pad(banner_pad(b)); }
+}
+
 /*!
- * \brief Prints the banner of a menu to the window
+ * \brief Shows the banner of a menu above its window
  *
  * \param[in] menu A menu struct
  * \param[in] menu_win The window for the choices of the menu
  *
- * \returns A new window on which the banner is printed
  */
-WINDOW* add_banner(const struct Menu* menu, WINDOW* menu_win)
+static void add_banner(const struct Menu* menu, WINDOW* menu_win)
+{
+    int const menu_middle = getmaxx(menu_win) / 2;
+    show_banner(menu->banner, menu->layout->y - menu->banner.dim.height,
+                menu->layout->x + menu_middle - menu->banner.dim.width / 2);
+}
+
+//! Convenience function to remove all artifacts of a window and release it to
+//! the pool of \ref take_window
+void win_cleanup(WINDOW* win) { release_window(win); }
+
+/*!
+ * \brief A menu shown on a window
+ *
+ * The window has room for \ref Menu_layout::view_height choices of the list,
+ * starting from \ref Menu_view::top, which is kept such that the highlighted
+ * choice is visible. Positions in the view refer to the list rather than to the
+ * choices of the menu, see \ref listed_choice.
+ */
+typedef struct Menu_view
+{
+    WINDOW* win;
+    struct Menu const* menu;
+    //! The choices listed, or NULL when all choices of the menu are in order
+    int const* order;
+    //! The number of choices listed
+    int len;
+    //! The first visible position
+    int top;
+    //! The highlighted position
+    int highlight;
+} Menu_view;
+
+//! Returns the choice of the menu at position pos of the list of view
+static int listed_choice(Menu_view const* view, int pos)
 {
-    if (!menu->banner.art) { return NULL; }
+    return view->order ? view->order[pos] : pos;
+}
 
-    int x                 = getmaxx(menu_win);
-    int const menu_middle = x / 2;
-    WINDOW* banner_win =
-        newwin(menu->banner.dim.height, menu->banner.dim.width,
-               menu->start_y - menu->banner.dim.height,
-               menu->start_x + menu_middle - menu->banner.dim.width / 2);
-    for (int i = 0; i < menu->banner.dim.height; ++i) {
-        mvwprintw(banner_win, i, 0, "%s", menu->banner.art[i]);
+//! Prints the line at a visible position of view, blank if nothing is listed
+//! there
+static void print_menu_line(Menu_view const* view, int pos)
+{
+    int const y = 1 + pos - view->top;
+    if (pos >= view->len) {
+        mvwhline(view->win, y, 1, ' ', getmaxx(view->win) - 2);
+        return;
     }
 
-    wrefresh(banner_win);
-    return banner_win;
+    bool const highlighted = pos == view->highlight;
+    int const choice       = listed_choice(view, pos);
+    mvwadd_wchnstr(view->win, y, 1,
+                   view->menu->choice_lines[2 * choice + highlighted],
+                   view->menu->choices_width + selection_offset);
+}
+
+//! Marks the box of view with arrows where choices are hidden above or below
+static void print_scroll_marks(Menu_view const* view)
+{
+    int const x      = getmaxx(view->win) - 2;
+    int const height = view->menu->layout->view_height;
+    bool const above = view->top > 0;
+    bool const below = view->top + height < view->len;
+
+    mvwaddch(view->win, 0, x, above ? ACS_UARROW : ACS_HLINE);
+    mvwaddch(view->win, height + 1, x, below ? ACS_DARROW : ACS_HLINE);
+}
+
+//! Prints every visible position of view, and stages its window
+static void print_visible_choices(Menu_view const* view)
+{
+    int const end = view->top + view->menu->layout->view_height;
+    for (int i = view->top; i < end; ++i) { print_menu_line(view, i); }
+    print_scroll_marks(view);
+    stage_window(view->win);
 }
 
-//! Convenience function to remove all artifacts of a window and release its
-//! resources
-void win_cleanup(WINDOW* win)
+/*!
+ * \brief Highlights the position to instead of the current one
+ *
+ * If to is visible, only the lines of the two positions are redrawn, so that
+ * the next frame compares and writes no more than those. Otherwise the
+ * view scrolls just far enough to show to and the visible positions are
+ * redrawn. Either way the cost doesn't depend on the number of choices.
+ */
+static void move_menu_highlight(Menu_view* view, int to)
 {
-    werase(win);
-    wrefresh(win);
-    delwin(win);
+    int const from = view->highlight;
+    if (from == to) { return; }
+
+    view->highlight  = to;
+    int const height = view->menu->layout->view_height;
+    if (to < view->top || to >= view->top + height) {
+        view->top = to < view->top ? to : to - height + 1;
+        print_visible_choices(view);
+        return;
+    }
+
+    print_menu_line(view, from);
+    print_menu_line(view, to);
+    stage_window(view->win);
 }
 
-//TODO: REMOVE X_ALIGN FROM INTERFACE
 /*!
- * \brief Prints the choice labels of a menu, highlighting the specified option
+ * \brief Prints the menu of view on its window
+ *
+ * This function clears the window and prints the menu on it, scrolled such
+ * that the highlighted choice is visible. Once shown, \ref move_menu_highlight
+ * keeps it up to date.
  *
- * \param[out] menu_win Window to print on
- * \param[in] menu Menu struct with choices to print
- * \param[in] highlight the number of the choice to be printed (0 indexed)
- * \param[in] x_align Offset from the windows left border
+ * \param[in,out] view The menu to print, and the window to print it on
  */
-void print_menu_highlight(WINDOW* menu_win, const struct Menu* menu,
-                          int highlight, int x_align)
+static void refresh_menu_view(Menu_view* view)
 {
-    // Compensate if menus contain non-ascii characters
-    int const u8_ascii_diff = (int)strlen(menu->choices[highlight]->label) -
-                              utf8_strlen(menu->choices[highlight]->label);
-    // +1 in order to account for '\0'-termination
-    int const total_len =
-        menu->choices_width + u8_ascii_diff + (int)strlen(selection_string) + 1;
+    int const height = view->menu->layout->view_height;
+    if (view->highlight < view->top) { view->top = view->highlight; }
+    if (view->highlight >= view->top + height) {
+        view->top = view->highlight - height + 1;
+    }
 
-    char* option = (char*)malloc(total_len);
+    wattroff(view->win, A_STANDOUT);
+    werase(view->win);
+    box(view->win, 0, 0);
+    print_visible_choices(view);
+}
 
-    int const sz = snprintf(option, total_len, u8"%s%s", selection_string,
-                            menu->choices[highlight]->label);
-    assert(sz == (int)strlen(menu->choices[highlight]->label) +
-                     (int)strlen(selection_string));
-    if (sz > total_len - 1) {
-        log_and_exit(
-            "Option string length exceeded total_len in print_menu_highlight "
-            "(%d and %d respectively).\n Aborting...\n",
-            sz + 1, total_len);
+/*!
+ * \brief Finds the position an action moves the highlight of view to
+ *
+ * Up and down move by one position and wrap around, page up and down by a
+ * view, and first and last go to the first and last position.
+ *
+ * \returns The position to highlight, the highlighted one for other actions
+ */
+static int menu_key_target(Menu_view const* view, Action action)
+{
+    int const last = view->len - 1;
+    int const page = view->menu->layout->view_height;
+    int const curr = view->highlight;
+    if (last < 0) { return curr; }
+
+    switch (action) {
+        case act_up       : return curr > 0 ? curr - 1 : last;
+        case act_down     : return curr < last ? curr + 1 : 0;
+        case act_page_up  : return curr > page ? curr - page : 0;
+        case act_page_down: return curr < last - page ? curr + page : last;
+        case act_first    : return 0;
+        case act_last     : return last;
+        default           : return curr;
     }
-    if (sz == -2) {
-        log_and_exit(
-            "sprintf encountered an error in print_menu_highlight.\n"
-            "Aborting...");
+}
+
+//! Checks if the action of event is one that \ref menu_key_target moves the
+//! highlight by
+static bool is_menu_move(Input_event const* event)
+{
+    switch (event->action) {
+        case act_up:
+        case act_down:
+        case act_page_up:
+        case act_page_down:
+        case act_first:
+        case act_last: return true;
+        default      : return false;
     }
+}
 
-    memset(option + sz, ' ', total_len - sz);
-    option[total_len - 1] = '\0';
+//! Checks if key types a character, UTF-8 included, rather than being a
+//! function key
+static bool is_typed_key(int key)
+{
+    return (key >= ' ' && key < ASCII_DEL) ||
+           (key > ASCII_DEL && key <= UCHAR_MAX);
+}
 
-    wattron(menu_win, A_STANDOUT);
-    mvwaddstr(menu_win, 1 + highlight, x_align, option);
-    wattroff(menu_win, A_STANDOUT);
-    free(option);
+//! Like \ref is_menu_move, but leaves the keys typing text to the filter
+static bool is_menu_move_untyped(Input_event const* event)
+{
+    return is_menu_move(event) && !is_typed_key(event->key);
 }
 
 /*!
- * \brief Prints the menu on the specified window
+ * \brief Moves the highlight of view by action, and by the keys moving it that
+ * are queued up behind it, see \ref read_queued_input
  *
- * This function clears the WINDOW and prints the menu on it, with the correct
- * choice highlighted.
+ * Only the position the highlight ends up at is drawn, so holding a key down
+ * costs one redraw per batch of keys rather than one per key. While typing
+ * filters the menu, keys typing text end the batch even if they are bound to
+ * moves, so that they are typed like they are when they aren't queued.
+ */
+static void move_menu_by_keys(Menu_view* view, Action action, bool filtering)
+{
+    bool (*const wanted)(Input_event const*) =
+        filtering ? is_menu_move_untyped : is_menu_move;
+    int const from     = view->highlight;
+    Input_event queued = {.action = action};
+    do {
+        view->highlight = menu_key_target(view, queued.action);
+    } while (read_queued_input(view->win, wanted, &queued));
+
+    int const to    = view->highlight;
+    view->highlight = from;
+    move_menu_highlight(view, to);
+}
+
+/*!
+ * \brief Text typed into a menu to filter its choices
  *
- * \param[out] menu_win Window to print on
- * \param[in] menu Menu to print
- * \param[in] highlight The choice to be highlighted
+ * The choices whose labels start with the first i bytes of \ref text, ignoring
+ * ASCII case, are the ones from lo[i] up to hi[i] in \ref
+ * Menu::sorted_choices. Every byte typed narrows the range of the previous one
+ * down, and erasing goes back to a range already found.
  */
-void refresh_menu_win(WINDOW* menu_win, const struct Menu* menu, int highlight)
+typedef struct Menu_filter
 {
-    // Printing menu box
-    wattroff(menu_win, A_STANDOUT);
-    werase(menu_win);
-    box(menu_win, 0, 0);
-    const int x_align = 1;
-    int y_align       = 1;
-    for (int i = 0; i < menu->choices_height; ++i) {
-        mvwprintw(menu_win, y_align, x_align, "%s", menu->choices[i]->label);
-        ++y_align;
+    char text[MENU_FILTER_MAX_LEN];
+    int len;
+    int lo[MENU_FILTER_MAX_LEN + 1];
+    int hi[MENU_FILTER_MAX_LEN + 1];
+} Menu_filter;
+
+static unsigned char fold_case(char c)
+{
+    unsigned char const u = (unsigned char)c;
+    return u >= 'A' && u <= 'Z' ? (unsigned char)(u - 'A' + 'a') : u;
+}
+
+/*!
+ * \brief Binary searches sorted choices sharing their first at bytes
+ *
+ * \returns The first of the choices from lo up to hi whose byte at, folded,
+ * is at least c, or greater than c if past is set
+ */
+static int filter_bound(struct Menu const* menu, int lo, int hi, int at,
+                        unsigned char c, bool past)
+{
+    while (lo < hi) {
+        int const mid = lo + (hi - lo) / 2;
+        unsigned char const m =
+            fold_case(menu->choices[menu->sorted_choices[mid]]->label[at]);
+        if (m < c || (past && m == c)) { lo = mid + 1; }
+        else {
+            hi = mid;
+        }
     }
+    return lo;
+}
 
-    print_menu_highlight(menu_win, menu, highlight, x_align);
-    wrefresh(menu_win);
+//! Narrows the range of filter down to the labels continuing with byte
+static void filter_append(struct Menu const* menu, Menu_filter* filter,
+                          char byte)
+{
+    int const n           = filter->len;
+    unsigned char const c = fold_case(byte);
+    filter->text[n]       = byte;
+    filter->lo[n + 1] =
+        filter_bound(menu, filter->lo[n], filter->hi[n], n, c, false);
+    filter->hi[n + 1] =
+        filter_bound(menu, filter->lo[n + 1], filter->hi[n], n, c, true);
+    filter->len = n + 1;
+}
+
+//! Erases the last UTF-8 character of the text of filter
+static void filter_erase(Menu_filter* filter)
+{
+    while (filter->len > 0 &&
+           ((unsigned char)filter->text[--filter->len] & 0xC0U) == 0x80U) {}
+}
+
+//! Prints the text of filter over the bottom of the box of view
+static void print_filter_text(Menu_view const* view, Menu_filter const* filter)
+{
+    int const y     = view->menu->layout->view_height + 1;
+    int const width = getmaxx(view->win) - 2;
+    mvwhline(view->win, y, 1, ACS_HLINE, width);
+    if (filter->len == 0) { return; }
+
+    // A character still being typed is left out until it is complete
+    mvwaddch(view->win, y, 1, '/');
+    mvwaddnstr(view->win, y, 2, filter->text,
+               utf8_complete_len(filter->text, filter->len));
+}
+
+//! Lists the choices matching filter in view, highlighting the first
+static void apply_filter(Menu_view* view, Menu_filter const* filter)
+{
+    struct Menu const* menu = view->menu;
+    int const n             = filter->len;
+    view->order = n > 0 ? menu->sorted_choices + filter->lo[n] : NULL;
+    view->len = n > 0 ? filter->hi[n] - filter->lo[n] : menu->choices_height;
+    view->top = 0;
+    view->highlight = 0;
+
+    print_filter_text(view, filter);
+    print_visible_choices(view);
+}
+
+//! Checks if keys typed into view filter it, which menus that scroll do
+static bool is_filtering(Menu_view const* view, Menu_filter const* filter)
+{
+    struct Menu const* menu = view->menu;
+    return menu->layout->view_height != menu->choices_height || filter->len > 0;
+}
+
+/*!
+ * \brief Filters the choices of a menu that scrolls by the text typed
+ *
+ * Printable characters, UTF-8 included, are added to the text whatever they
+ * are bound to, and keys bound to \ref act_erase erase from it.
+ *
+ * \returns true if the key of in was used for filtering
+ */
+static bool filter_key(Menu_view* view, Menu_filter* filter, Input_event in)
+{
+    if (!is_filtering(view, filter)) { return false; }
+
+    if (in.action == act_erase) {
+        if (filter->len == 0) { return true; }
+        filter_erase(filter);
+    }
+    else if (is_typed_key(in.key)) {
+        if (filter->len == MENU_FILTER_MAX_LEN) { return true; }
+        filter_append(view->menu, filter, (char)in.key);
+    }
+    else {
+        return false;
+    }
+
+    apply_filter(view, filter);
+    return true;
+}
+
+/*!
+ * \brief Returns where menu goes on the screen as it is now
+ *
+ * The layout is kept in \ref Menu::layout and only worked out again when the
+ * screen has changed size since, so that neither showing a menu nor a burst of
+ * resizes works it out more than once per size.
+ */
+static Menu_layout const* layout_menu(struct Menu const* menu)
+{
+    Menu_layout* layout = menu->layout;
+    if (layout->screen.height == LINES && layout->screen.width == COLS) {
+        return layout;
+    }
+
+    // Menus taller than the room left by the banner and the box scroll
+    int const room = (menu->start_y < 0 ? LINES - menu->banner.dim.height
+                                        : LINES - menu->start_y) -
+                     2;
+    int height = menu->choices_height < room ? menu->choices_height : room;
+    // However small the screen, one choice is shown
+    if (height < 1) { height = 1; }
+
+    int x = menu->start_x;
+    if (x < 0) { x = (COLS - (menu->choices_width + 2)) / 2; }
+    int y = menu->start_y;
+    if (y < 0) { y = (LINES - (height + 2) + menu->banner.dim.height) / 2; }
+
+    *layout = (Menu_layout){{LINES, COLS}, x, y, height};
+    return layout;
+}
+
+//! Returns the size of the window of menu for layout
+static Dim menu_win_dim(struct Menu const* menu, Menu_layout const* layout)
+{
+    return (Dim){layout->view_height + 2,
+                 menu->choices_width + 2 + utf8_strlen(selection_string)};
+}
+
+//! Creates the window of a menu, large enough for its visible choices
+static WINDOW* new_menu_win(struct Menu const* menu)
+{
+    Menu_layout const* layout = layout_menu(menu);
+    Dim const dim             = menu_win_dim(menu, layout);
+    WINDOW* win = take_window(dim.height, dim.width, layout->y, layout->x);
+    intrflush(win, false);
+    keypad(win, true);
+    return win;
+}
+
+/*!
+ * \brief Moves view and the banner of its menu to fit the screen as it is now
+ *
+ * A menu that has to move is printed again, filter included if there is one,
+ * and one that stays where it is isn't touched.
+ */
+static void relayout_menu_view(Menu_view* view, Menu_filter const* filter)
+{
+    struct Menu const* menu   = view->menu;
+    Menu_layout const* layout = layout_menu(menu);
+    Dim const dim             = menu_win_dim(menu, layout);
+    if (move_window(view->win, dim.height, dim.width, layout->y, layout->x)) {
+        refresh_menu_view(view);
+        if (filter && filter->len > 0) {
+            print_filter_text(view, filter);
+            stage_window(view->win);
+        }
+    }
+    add_banner(menu, view->win);
 }
 
 /*!
@@ -227,52 +784,121 @@ int get_menu_width(struct Menu const* menu)
     return max > menu->choices_width ? max : menu->choices_width;
 }
 
+//! Converts label into the cells of a line of a menu, padded with blanks up to
+//! columns, and returns the cell after them
+static cchar_t* label_cells(char const* label, bool highlighted, int columns,
+                            cchar_t* cells)
+{
+    attr_t const attr = highlighted ? A_STANDOUT : A_NORMAL;
+    int len           = 0;
+    if (highlighted) {
+        len = utf8_to_cells(selection_string, -1, attr, cells);
+    }
+    len += utf8_to_cells(label, -1, attr, cells + len);
+
+    wchar_t const blank[] = {L' ', L'\0'};
+    for (; len < columns; ++len) {
+        setcchar(&cells[len], blank, attr, 0, NULL);
+    }
+    return cells + columns;
+}
+
+/*!
+ * \brief Builds \ref Menu::choice_lines
+ *
+ * The lines are allocated together with the pointers to them, and are all
+ * padded to the width of the choices plus the selection string.
+ *
+ * \param[in,out] menu Menu whose width has been calculated
+ */
+static void build_menu_lines(struct Menu* menu)
+{
+    int const columns      = menu->choices_width + selection_offset;
+    size_t const lines_len = 2 * (size_t)menu->choices_height;
+
+    // A label may be followed by the empty cell ending its conversion, which
+    // the next line overwrites, so the last line needs room for one more
+    size_t const pointers = sizeof(cchar_t*) * lines_len;
+    size_t const cells    = sizeof(cchar_t) * (lines_len * (size_t)columns + 1);
+    cchar_t const** lines =
+        (cchar_t const**)tracked_malloc(sub_menu, pointers + cells);
+    cchar_t* at = (cchar_t*)((char*)lines + pointers);
+    for (int i = 0; i < menu->choices_height; ++i) {
+        char const* label = menu->choices[i]->label;
+
+        lines[2 * i]     = at;
+        at               = label_cells(label, false, columns, at);
+        lines[2 * i + 1] = at;
+        at               = label_cells(label, true, columns, at);
+    }
+    assert((char*)at == (char*)lines + pointers + cells - sizeof(cchar_t));
+
+    tracked_free((void*)menu->choice_lines);
+    menu->choice_lines = lines;
+}
+
 /*!
  * Prints the passed in menu according to its parameters and then blocks until
  * a choice has been selected. At that point, the \ref Option::command::execute
  * associated with the choice is executed, and the returned Command is passed
  * back to the caller
  *
+ * While waiting for a key the menu is the \ref Context::checkpoint of ctx.
+ * Typing into a menu that doesn't fit on screen filters its choices, see \ref
+ * Menu::sorted_choices.
+ *
+ * \param[in,out] ctx The context of the session
  * \param[in] menu Menu to be printed
  * \returns The \ref Command returned by the selected choice
  */
-Command* print_menu(const struct Menu* menu, int select)
+Command* print_menu(Context* ctx, const struct Menu* menu, int select)
 {
-    WINDOW* menu_win =
-        newwin(menu->choices_height + 2,
-               menu->choices_width + 2 + utf8_strlen(selection_string),
-               menu->start_y, menu->start_x);
-    WINDOW* title_win = add_banner(menu, menu_win);
-    intrflush(menu_win, false);
-    keypad(menu_win, true);
-
-    box(menu_win, 0, 0);
-
-    refresh_menu_win(menu_win, menu, select);
-
-    int ch = 0;
+    Menu_command checkpoint = {
+        .command = {.execute = show_menu, .persistent = true},
+        .menu    = menu
+    };
+
+    Menu_view view = {.win  = new_menu_win(menu),
+                      .menu = menu,
+                      .len  = menu->choices_height};
+    add_banner(menu, view.win);
+    view.highlight = select;
+    refresh_menu_view(&view);
+    Menu_filter filter = {.hi = {menu->choices_height}};
+
+    Input_event in = {0};
     while (true) {
-        ch = wgetch(menu_win);
-        switch (ch) {
-            case KEY_UP:
-                select =
-                    (select + menu->choices_height - 1) % menu->choices_height;
-                break;
-            case KEY_DOWN : select = (select + 1) % menu->choices_height; break;
-            case LINE_FEED: {
-                struct Option const* const curr = menu->choices[select];
-                if (curr->command->execute) {
-                    win_cleanup(menu_win);
-                    win_cleanup(title_win);
-
-                    return curr->command;
-                }
+        if (menu_selector) {
+            // The selection stands in for a key, and so starts a new frame
+            arena_reset(frame_arena());
+            move_menu_highlight(&view, menu_selector(menu, view.highlight));
+            start_alloc_frame();
+            in = (Input_event){.action = act_select};
+        }
+        else {
+            // A filtered menu is restored unfiltered, at the same choice
+            checkpoint.highlight =
+                view.len > 0 ? listed_choice(&view, view.highlight) : 0;
+            ctx->checkpoint = (Command*)&checkpoint;
+            in              = read_input(ctx, view.win);
+            ctx->checkpoint = NULL;
+        }
+        if (in.action == act_resize) {
+            relayout_menu_view(&view, &filter);
+            continue;
+        }
+        if (in.action == act_select && view.len > 0) {
+            struct Option const* const curr =
+                menu->choices[listed_choice(&view, view.highlight)];
+            if (curr->command->execute) {
+                win_cleanup(view.win);
+                hide_banner(menu->banner);
+
+                return curr->command;
             }
-            default:;
         }
-        refresh_menu_win(menu_win, menu, select);
-        //TODO: Can probably be removed
-        //refresh_banner(title_win, menu, menu_win);
+        if (filter_key(&view, &filter, in)) { continue; }
+        move_menu_by_keys(&view, in.action, is_filtering(&view, &filter));
     }
 }
 
@@ -281,42 +907,41 @@ Command* print_menu(const struct Menu* menu, int select)
  * a choice has been selected. Afterwards an integer corresponding to choice
  * selectes is returned.
  *
+ * \param[in,out] ctx The context of the session
  * \param[in] menu The menu to print
  * \returns An index in the range [0, menu.choices_height) indicating the
  *  selected choice
  */
-int print_menu_old(const struct Menu* menu)
+int print_menu_old(Context* ctx, const struct Menu* menu)
 {
-    WINDOW* menu_win =
-        newwin(menu->choices_height + 2,
-               menu->choices_width + 2 + utf8_strlen(selection_string),
-               menu->start_y, menu->start_x);
-    WINDOW* title_win = add_banner(menu, menu_win);
-    intrflush(menu_win, false);
-    keypad(menu_win, TRUE);
-
-    box(menu_win, 0, 0);
-
-    int option = 0;
-    refresh_menu_win(menu_win, menu, option);
+    Menu_view view = {.win  = new_menu_win(menu),
+                      .menu = menu,
+                      .len  = menu->choices_height};
+    add_banner(menu, view.win);
+    refresh_menu_view(&view);
 
-    int ch = 0;
+    Action action = act_none;
     while (true) {
-        ch = wgetch(menu_win);
-        switch (ch) {
-            case KEY_UP:
-                option =
-                    (option + menu->choices_height - 1) % menu->choices_height;
-                break;
-            case KEY_DOWN: option = (option + 1) % menu->choices_height; break;
-            case LINE_FEED:
-                win_cleanup(menu_win);
-                win_cleanup(title_win);
-
-                return option;
-            default:;
+        if (menu_selector) {
+            arena_reset(frame_arena());
+            move_menu_highlight(&view, menu_selector(menu, view.highlight));
+            start_alloc_frame();
+            action = act_select;
+        }
+        else {
+            action = read_input(ctx, view.win).action;
+        }
+        if (action == act_resize) {
+            relayout_menu_view(&view, NULL);
+            continue;
+        }
+        if (action == act_select) {
+            win_cleanup(view.win);
+            hide_banner(menu->banner);
+
+            return view.highlight;
         }
-        refresh_menu_win(menu_win, menu, option);
+        move_menu_by_keys(&view, action, false);
     }
 }
 
@@ -324,46 +949,93 @@ int print_menu_old(const struct Menu* menu)
  * Prints the passed in strings as a menu to screen and returns the index of the
  * selected choice
  *
+ * \param[in,out] ctx The context of the session
  * \param[in] count The number of variadic arguments passed
  * \param[in] ... Strings to be used as labels for the menu options
  *
  * \returns An integer in the range [0, count) indicating the selected choice
  */
-int quick_print_menu(int width, int count, ...)
+int quick_print_menu(Context* ctx, int width, int count, ...)
 {
     assert(count > 0);
 
+    if (count > QUICK_MENU_MAX_CHOICES) {
+        log_and_exit("quick_print_menu takes at most %d choices, not %d\n",
+                     QUICK_MENU_MAX_CHOICES, count);
+    }
+
     va_list va = {0};
     va_start(va, count);
 
-    //Could be optimised by just allocating a Option* and filling it with
-    //commands, then creating an array and filling that with pointers to
-    //individual elements, thus saving on mallocs
-    Option** choices = (Option**)malloc(count * sizeof(Option*));
-    for (int i = 0; i < count; ++i) { choices[i] = malloc(sizeof(Option)); }
-
-    assert(count > 0);
+    // The menu lives across key presses, so it can't use the frame arena
+    Option options[QUICK_MENU_MAX_CHOICES];
+    Option const* choices[QUICK_MENU_MAX_CHOICES];
     for (int i = 0; i < count; ++i) {
-        char const* ch      = va_arg(va, char const*);
-        choices[i]->label   = ch;
-        choices[i]->command = NULL;
+        options[i] = (Option){.label = va_arg(va, char const*)};
+        choices[i] = &options[i];
     }
 
-    Menu m = {(Option const**)choices, count, width, {.art = NULL}, -1, -1};
+    Menu m = {.choices        = choices,
+              .choices_height = count,
+              .choices_width  = width,
+              .banner         = {.art = NULL},
+              .start_x        = -1,
+              .start_y        = -1};
     implementation_initialise_menu(&m);
 
-    int res = print_menu_old(&m);
-    for (int i = 0; i < count; ++i) { free(choices[i]); }
-    free((void*)choices);
+    int res = print_menu_old(ctx, &m);
+    implementation_release_menu(&m);
     va_end(va);
     return res;
 }
 
+//! A label and the choice it belongs to, for sorting
+typedef struct Sort_entry
+{
+    char const* label;
+    int choice;
+} Sort_entry;
+
+//! Orders labels by their bytes, ignoring ASCII case
+static int compare_labels(void const* a, void const* b)
+{
+    char const* x = ((Sort_entry const*)a)->label;
+    char const* y = ((Sort_entry const*)b)->label;
+    while (*x && fold_case(*x) == fold_case(*y)) {
+        ++x;
+        ++y;
+    }
+    int const diff = fold_case(*x) - fold_case(*y);
+    if (diff != 0) { return diff; }
+    return ((Sort_entry const*)a)->choice - ((Sort_entry const*)b)->choice;
+}
+
+//! Returns the choices of menu ordered by their labels, see \ref
+//! Menu::sorted_choices
+static int* sort_choices(struct Menu const* menu)
+{
+    size_t const n = (size_t)menu->choices_height;
+    Sort_entry* entries =
+        (Sort_entry*)arena_alloc(frame_arena(), sizeof(Sort_entry) * n);
+    for (int i = 0; i < menu->choices_height; ++i) {
+        entries[i] = (Sort_entry){menu->choices[i]->label, i};
+    }
+    qsort(entries, n, sizeof(Sort_entry), compare_labels);
+
+    int* res = (int*)tracked_malloc(sub_menu, sizeof(int) * n);
+    for (int i = 0; i < menu->choices_height; ++i) {
+        res[i] = entries[i].choice;
+    }
+    return res;
+}
+
 /*!
  * \brief Initialise menu with information only available at runtime
  *
- * This function calculates the width of the menu, and centers the menu if it's
- * start position is not set
+ * This function calculates the width of the menu, builds the lines of its
+ * choices (see \ref Menu::choice_lines) and the index for filtering them (see
+ * \ref Menu::sorted_choices). Where the menu goes on screen is left to when it
+ * is shown, see \ref Menu::layout. Initialising a menu again rebuilds them.
  *
  * \param[in,out] menu Menu to initialise
  */
@@ -371,23 +1043,34 @@ void implementation_initialise_menu(struct Menu* menu)
 {
     menu->choices_width = get_menu_width(menu);
     assert(menu->choices_width + utf8_strlen(selection_string) + 2 <= COLS);
+    build_menu_lines(menu);
 
-    if (menu->banner.art) {
+    if (!banner_art(menu->banner)) { menu->banner.dim = (Dim){0, 0}; }
+    // Banners packed from the art of the game come measured
+    else if (!menu->banner.packed && menu->banner.dim.width == 0) {
         menu->banner.dim.width = get_banner_width(menu->banner);
-        assert(menu->banner.dim.width <= COLS);
-    }
-    else {
-        menu->banner.dim.width  = 0;
-        menu->banner.dim.height = 0;
     }
+    assert(menu->banner.dim.width <= COLS);
 
-    if (menu->start_x < 0) {
-        menu->start_x = (COLS - (menu->choices_width + 2)) / 2;
-    }
-    if (menu->start_y < 0) {
-        int height    = (menu->banner.art) ? menu->banner.dim.height : 0;
-        menu->start_y = (LINES - (menu->choices_height + 2) + height) / 2;
+    // Any menu may scroll once the screen is small enough
+    tracked_free(menu->sorted_choices);
+    menu->sorted_choices = sort_choices(menu);
+
+    if (!menu->layout) {
+        menu->layout =
+            (Menu_layout*)tracked_malloc(sub_menu, sizeof *menu->layout);
     }
+    *menu->layout = (Menu_layout){0};
+}
+
+void implementation_release_menu(struct Menu* menu)
+{
+    tracked_free((void*)menu->choice_lines);
+    tracked_free(menu->sorted_choices);
+    tracked_free(menu->layout);
+    menu->choice_lines   = NULL;
+    menu->sorted_choices = NULL;
+    menu->layout         = NULL;
 }
 
 /*!
@@ -400,8 +1083,6 @@ struct Dia_print
 {
     //! File pointer to dialogue
     FILE* file;
-    //! The path to the dialogue
-    const char* path;
     //! The current line
     int line;
     //! The current horizontal position
@@ -474,13 +1155,10 @@ int print_next_word(WINDOW* win, struct Dia_print* dia)
  */
 int get_dia_height(const struct Dia_print* dia)
 {
-    FILE* file = fopen(dia->path, "r");
-    if (!file) {
-        log_and_exit("fopen encountered an error in get_dia_height\n");
-    }
-    int err = fseek(file, ftell(dia->file), SEEK_SET);
-    if (err != 0) {
-        log_and_exit("fseek encountered an error in get_dia_height\n");
+    FILE* file       = dia->file;
+    long const start = ftell(file);
+    if (start == -1) {
+        log_and_exit("ftell encountered an error in get_dia_height\n");
     }
 
     int word_len = 0;
@@ -491,7 +1169,10 @@ int get_dia_height(const struct Dia_print* dia)
     char buf[ASCII_BUF_SZ];
     while (true) {
         int const err = fload_utf8(buf, file);
-        if (err == 1) { return -1; }
+        if (err == 1) {
+            height = -1;
+            break;
+        }
         if (err == EOF || strcmp(buf, u8"§") == 0) { break; }
 
         ++len;
@@ -506,6 +1187,9 @@ int get_dia_height(const struct Dia_print* dia)
             len = word_len - 1;
         }
     }
+    if (fseek(file, start, SEEK_SET) != 0) {
+        log_and_exit("fseek encountered an error in get_dia_height\n");
+    }
 
     return height;
 }
@@ -516,6 +1200,21 @@ typedef struct print_dia_win_res
     int res;
 } Print_dia_win_res;
 
+//! Returns the y-coordinate of a dialogue window of height with banner b
+static int dialogue_y(int height, Banner b)
+{
+    return (LINES - height + b.dim.height) / 2;
+}
+
+//! Moves dia_win, of dim, and shows b above it to fit the screen as it is now
+static void place_dialogue(WINDOW* dia_win, Dim dim, Banner b)
+{
+    move_window(dia_win, dim.height, dim.width, dialogue_y(dim.height, b),
+                (COLS - dim.width) / 2);
+    show_banner(b, (LINES - dim.height - b.dim.height) / 2,
+                (COLS - b.dim.width) / 2);
+}
+
 /*!
  * \brief Prints a dialogue to screen
  *
@@ -531,13 +1230,11 @@ Print_dia_win_res print_dia_win(struct Dia_print dia_p, Banner b)
 {
     int height = get_dia_height(&dia_p);
 
-    int const dia_y_pos = (LINES - (2 + height));
-    //int const dia_x_pos = (COLS - (2 + dia_p.width));
-
     // Create a centered window with padding for borders
-    WINDOW* dia_win =
-        newwin(2 + height, 2 + dia_p.width, (dia_y_pos + b.dim.height) / 2,
-               (COLS - (2 + dia_p.width)) / 2);
+    Dim const dim   = {2 + height, 2 + dia_p.width};
+    WINDOW* dia_win = take_window(dim.height, dim.width,
+                                  dialogue_y(dim.height, b),
+                                  (COLS - dim.width) / 2);
 
     intrflush(dia_win, false);
     keypad(dia_win, true);
@@ -554,26 +1251,49 @@ Print_dia_win_res print_dia_win(struct Dia_print dia_p, Banner b)
         }
     }
 
-    WINDOW* banner_win = NULL;
-    if (b.art) {
-        banner_win =
-            newwin(b.dim.height, b.dim.width, (dia_y_pos - b.dim.height) / 2,
-                   (COLS - b.dim.width) / 2);
-        paint_banner(banner_win, b);
-    }
     if (r_code == 2) {
-        wrefresh(dia_win);
-        if (banner_win) { wrefresh(banner_win); }
-        wait_press((Input){.win = dia_win, .tag = tag_win});
+        stage_window(dia_win);
+        place_dialogue(dia_win, dim, b);
+        // Resizing moves the dialogue rather than closing it
+        while (wait_press((Input){.win = dia_win, .tag = tag_win}) ==
+               KEY_RESIZE) {
+            place_dialogue(dia_win, dim, b);
+        }
+        hide_banner(b);
     }
-
     win_cleanup(dia_win);
-    if (banner_win) { win_cleanup(banner_win); }
 
     Print_dia_win_res res = {.error = false, .res = r_code};
     return res;
 }
 
+//! Prints the dialogue read from f like \ref print_dia, and closes f
+static int print_dia_file(FILE* f, Banner b, int width)
+{
+    if (width + 2 > COLS) {
+        log_msgln(
+            "Dialogue with width wider than COLS (columns) passed to "
+            "print_dia\n");
+    }
+    struct Dia_print dia = {f, .line = 1, .line_len = 0, .width = width};
+
+    while (true) {
+        Print_dia_win_res code = print_dia_win(dia, b);
+        if (code.error) {
+            int err = fclose(f);
+            if (err) {
+                log_msgf("fclose failed in %s with error: '%s'", __func__,
+                         strerror(errno));
+            }
+            return -1;
+        }
+        else if (code.res == 1) {
+            (void)fclose(f);
+            return 0;
+        }
+    }
+}
+
 /*!
  * This function will print a dialogue to screen, according to the content of a
  * specified file, and a specified width In order for the dialogue file to
@@ -592,12 +1312,7 @@ Print_dia_win_res print_dia_win(struct Dia_print dia_p, Banner b)
  */
 int print_dia(const char* file_path, Banner b, int width)
 {
-    if (width + 2 > COLS) {
-        log_msgln(
-            "Dialogue with width wider than COLS (columns) passed to "
-            "print_dia\n");
-    }
-    FILE* f = fopen(file_path, "r");
+    FILE* f = open_dialogue(file_path);
 
     if (!f) {
         log_and_exit(
@@ -605,24 +1320,8 @@ int print_dia(const char* file_path, Banner b, int width)
             "%s\n",
             file_path, strerror(errno));
     }
-    struct Dia_print dia = {f, .path = file_path, .line = 1, .line_len = 0,
-                            .width = width};
 
-    while (true) {
-        Print_dia_win_res code = print_dia_win(dia, b);
-        if (code.error) {
-            int err = fclose(f);
-            if (err) {
-                log_msgf("fclose failed in %s with error: '%s'", __func__,
-                         strerror(errno));
-            }
-            return -1;
-        }
-        else if (code.res == 1) {
-            (void)fclose(f);
-            return 0;
-        }
-    }
+    return print_dia_file(f, b, width);
 }
 
 /*!
@@ -639,57 +1338,26 @@ int print_dia(const char* file_path, Banner b, int width)
  */
 int print_diastr(char const* const str)
 {
-    char const tmpl[] = "/tmp/tmpdia.XXXXXX";
-    int fd            = mkstemp((char*)tmpl);
-    if (fd == -1) {
-        log_and_exit("Failed to make temporary file in %s, aborting...\n",
-                     __func__);
-    }
-    FILE* temp = fdopen(fd, "w");
-    if (!temp) {
-        log_and_exit("Call to fdopen failed in %s, aborting...\n", __func__);
-    }
-    int b = fputs(str, temp);
+    char const end[] = u8"\n§\n";
+    size_t const len = strlen(str);
+    char* text       = (char*)tracked_malloc(sub_menu, len + sizeof end);
+    memcpy(text, str, len);
+    memcpy(text + len, end, sizeof end);
 
-    if (b == EOF) {
-        log_msgln("fputs failed in print_diastr");
+    FILE* f = fmemopen(text, len + sizeof end - 1, "r");
+    if (!f) {
+        tracked_free(text);
+        log_msgln("fmemopen failed in print_diastr");
         return -1;
     }
 
-    int err = fputs(u8"\n§\n", temp);
-    if (err == EOF) {
-        (void)fclose(temp);
-        log_msgln("fputs failed in print_diastr");
-        return -2;
-    }
-    err = fflush(temp);
-    if (err == EOF) {
-        (void)fclose(temp);
-        log_msgf("fflush failed in print_diastr, with errno value: %s\n",
-                 strerror(errno));
-        return -3;
-    }
-
-    err = print_dia(tmpl, (Banner){.art = NULL}, utf8_strlen(str));
+    int err = print_dia_file(f, (Banner){.art = NULL}, utf8_strlen(str));
+    tracked_free(text);
     if (err == -1) {
-        (void)fclose(temp);
         log_msgln("print_dia failed in print_diastr");
-        return -6; //NOLINT
-    }
-
-    err = fclose(temp);
-    if (err == EOF) {
-        log_msgln("fclose failed in print_diastr");
-        return -4;
-    }
-
-    err = remove(tmpl);
-    if (err == -1) {
-        log_msgln("failed to remove file in print_diastr");
-        return -5; //NOLINT
+        return -2;
     }
 
-
     return 0;
 }
 
@@ -697,10 +1365,10 @@ int print_diastr(char const* const str)
  * \this A \ref Menu_command* to use when printing
  * \returns The result of print_menu executed on the information in this
  */
-Command* show_menu(void* this)
+Command* show_menu(void* this, Context* ctx)
 {
     Menu_command* mc = (Menu_command*)this;
-    Command* option  = print_menu(mc->menu, mc->highlight);
+    Command* option  = print_menu(ctx, mc->menu, mc->highlight);
 
     return option;
 }
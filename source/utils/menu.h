@@ -49,20 +49,71 @@ typedef struct Dim
     int width;
 } Dim;
 
+//! The codes of \ref Packed_art that aren't glyphs
+enum Art_code
+{
+    //! Ends a line
+    ART_LINE_END = 254,
+    //! Followed by a count and a code, which is repeated count times
+    ART_RUN = 255
+};
+
+/*!
+ * \brief Art packed when the game is built, see tools/banner.py
+ *
+ * Art is mostly runs of blanks, and is drawn with few distinct glyphs, where a
+ * braille glyph takes three bytes of UTF-8. Packed, every glyph is a byte
+ * indexing the glyphs of the art, and a run of a glyph is three bytes, see
+ * \ref Art_code.
+ */
+typedef struct Packed_art
+{
+    //! The code points the art is drawn with, indexed by codes
+    wchar_t const* glyphs;
+    //! The codes of every line, one line after the other
+    unsigned char const* codes;
+} Packed_art;
+
 //! Holds information about 2D art
 typedef struct Banner
 {
-    //! A 2D char array of dimensions \ref dim
+    //! A 2D char array of dimensions \ref dim, or NULL if the art is packed
     char const* const* art;
     //! The height and width of the art array
     Dim dim;
+    //! The art of the game, packed when it was built
+    Packed_art const* packed;
 } Banner;
 
+//! Initialiser of a Banner without art, see \ref MAKE_MENU
+#define NO_BANNER() {.art = NULL}
+
 /* <--- Banner members ---> */
 /*!
  * \var Banner::dim The width is specified in number of unicode code points
+ *
+ * The art of the game is packed into C when it is built, along with
+ * initialisers of Banners, e.g. WELL_BANNER(), that hold the dimensions of the
+ * art, see tools/banner.py. It is only unpacked the first time it is painted.
+ * Banners made at runtime from lines of UTF-8 are measured by \ref
+ * make_banner, or when their menu is initialised.
  */
 
+/*!
+ * \brief Where a menu goes on a screen of some size, see \ref Menu::layout
+ */
+typedef struct Menu_layout
+{
+    //! The size of the screen the layout is for
+    Dim screen;
+    //! x-coordinate of the upper left corner of the box of the choices
+    int x;
+    //! y-coordinate of the upper left corner of the box of the choices
+    int y;
+    //! The number of choices visible at once, the rest is scrolled to
+    int view_height;
+} Menu_layout;
+
 /*!
  * \brief Holds menu information
  *
@@ -83,10 +134,17 @@ typedef struct Menu
     int choices_width;
     //! 2D UTF-8 char array printed above the menu
     Banner banner;
-    //! x-coordinate of the menus upper left corner
+    //! x-coordinate of the menus upper left corner, negative to center it
     int start_x;
-    //! y-coordinate of the menus upper left corner
+    //! y-coordinate of the menus upper left corner, negative to center it
     int start_y;
+    //! The lines drawn for the choices, built by \ref
+    //! implementation_initialise_menu
+    cchar_t const** choice_lines;
+    //! Index for filtering the choices while the menu scrolls
+    int* sorted_choices;
+    //! Where the menu goes on the screen it was last shown on
+    Menu_layout* layout;
 } Menu;
 
 /* <--- Menu members ---> */
@@ -98,6 +156,26 @@ typedef struct Menu
  * \var Menu::choices_width
  * If all choice labels are shorter than this, the menu is
  * padded with whitespace.
+ *
+ * \var Menu::choice_lines
+ * Holds two lines per choice, the plain one at 2 * i and the highlighted one at
+ * 2 * i + 1. Both are padded to the full width of the menu, so drawing either
+ * over the other leaves nothing behind, and redrawing a menu only copies them.
+ * They are cells rather than UTF-8, with the highlighted line standing out, so
+ * that copying them doesn't decode the labels again.
+ *
+ * \var Menu::sorted_choices
+ * The indices of the choices ordered by their labels, ignoring ASCII case.
+ * Typing into a menu that scrolls filters it down to the labels starting with
+ * what was typed, which are next to each other in this order and found by
+ * binary search.
+ *
+ * \var Menu::layout
+ * Worked out from the size of the screen and the start position, and only
+ * again when the menu is shown on a screen of another size, so that a resize
+ * costs one layout per menu. It is allocated by \ref
+ * implementation_initialise_menu, which leaves it to be worked out when first
+ * needed.
  */
 
 /*! \brief structure for dialogues
@@ -132,10 +210,9 @@ void win_cleanup(WINDOW* win);
  * const char* const example[3] = [ "one", "two", "three"] has to be defined
  * when creating example_menu
  *
- *  \param banner The name of a global char* array containing the banner (ascii
- * art) to be printed above the menu's choices. Every string in the array has to
- * consist of the same number of unicode code points May be left NULL for no
- * banner.
+ *  \param banner The name of a macro giving the initialiser of the Banner
+ * (ascii art) to be printed above the menu's choices, e.g. WELL_BANNER
+ * generated from the art of the game, or \ref NO_BANNER for no banner.
  *
  * \param min_choice_width A minimum width for the choices box. Will be exceeded
  * if the length of the options demands it
@@ -163,9 +240,7 @@ void win_cleanup(WINDOW* win);
         .choices        = (struct Option const**)(menu_name),                    \
         .choices_height = CHOICES_LEN(menu_name),                                \
         .choices_width  = (min_choice_width),                                    \
-        .banner         = (Banner){.art = (const char**)(menu_banner),           \
-                                   .dim = {.height = (int)(sizeof(menu_banner) / \
-                                                   sizeof(char*))}},     \
+        .banner         = menu_banner(),                                         \
         .start_x        = (x),                                                   \
         .start_y        = (y),                                                   \
     };                                                                           \
@@ -187,10 +262,9 @@ void win_cleanup(WINDOW* win);
  * const char* const example[3] = [ "one", "two", "three"] has to be defined
  * when creating example_menu
  *
- *  \param banner The name of a global char* array containing the banner (ascii
- * art) to be printed above the menu's choices. Every string in the array has to
- * consist of the same number of unicode code points May be left NULL for no
- * banner.
+ *  \param banner The name of a macro giving the initialiser of the Banner
+ * (ascii art) to be printed above the menu's choices, e.g. WELL_BANNER
+ * generated from the art of the game, or \ref NO_BANNER for no banner.
  *
  * \param min_width A minimum width for the menu choices. Will be exceeded if
  * the length of the options demands it
@@ -232,16 +306,37 @@ Command* new_menu_command(Menu const* menu, int highlight);
 //! Construct a banner with the correct width
 Banner make_banner(char const* const* art, int height);
 
+//! Paints b on win with its upper left corner at (y, x), converting its art
+//! to cells the first time
+void paint_banner(WINDOW* win, Banner b, int y, int x);
+
 //! Loads the path to the dialogue directory into buf
 void get_dialogue_path(char* buf, int sz);
 
+//! Keeps all dialogues in memory from now on
+void preload_dialogues(void);
+
 void implementation_initialise_menu(struct Menu* menu);
 
+//! Frees what \ref implementation_initialise_menu allocated for menu
+void implementation_release_menu(struct Menu* menu);
+
+/*!
+ * \brief Function choosing a menu option in place of the keyboard
+ *
+ * Is called with the menu being shown and the currently highlighted choice,
+ * and returns the index of the choice to select.
+ */
+typedef int (*Menu_selector)(Menu const* menu, int highlight);
+
+//! Routes menu selection through selector instead of the keyboard (NULL resets)
+void set_menu_selector(Menu_selector selector);
+
 //! Prints a menu with a \ref Option::on_select executed on select
-Command* print_menu(const struct Menu* menu, int select);
+Command* print_menu(Context* ctx, const struct Menu* menu, int select);
 
-//! Conveniently print a minimalistic menu
-int quick_print_menu(int width, int count, ...);
+//! Conveniently print a minimalistic menu of at most 8 choices
+int quick_print_menu(Context* ctx, int width, int count, ...);
 
 //! Prints the passed in dialogue file to screen with indicated width
 int print_dia(const char* file_path, Banner b, int width);
@@ -250,4 +345,4 @@ int print_dia(const char* file_path, Banner b, int width);
 int print_diastr(char const* const str);
 
 //! \ref Command::execute "Execute" that prints a menu
-Command* show_menu(void*);
+Command* show_menu(void*, Context*);
@@ -3,6 +3,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "accounting.h"
+#include "arena.h"
 #include "vec.h"
 
 //NOLINTBEGIN
@@ -11,16 +13,32 @@ struct Vec
     int sz;
     int cap;
     void* data;
+    struct Arena* arena;
 };
 
-void free_vec(void* v) { free(((struct Vec*)v)->data); }
+void free_vec(void* v)
+{
+    if (!((struct Vec*)v)->arena) { tracked_free(((struct Vec*)v)->data); }
+}
+
+static void* vec_alloc(struct Arena* arena, size_t size)
+{
+    return arena ? arena_alloc(arena, size) : tracked_malloc(sub_vec, size);
+}
 
 #define CREATE_VEC(type, eq_fnc)                                               \
                                                                                \
-    Vec_##type new_vec_##type(int cap)                                         \
+    Vec_##type new_vec_##type##_in(struct Arena* arena, int cap)               \
     {                                                                          \
         return (Vec_##type){                                                   \
-            .sz = 0, .cap = cap, .data = (type*)malloc(cap * sizeof(type))};   \
+            .sz    = 0,                                                        \
+            .cap   = cap,                                                      \
+            .data  = (type*)vec_alloc(arena, cap * sizeof(type)),              \
+            .arena = arena};                                                   \
+    }                                                                          \
+    Vec_##type new_vec_##type(int cap)                                         \
+    {                                                                          \
+        return new_vec_##type##_in(NULL, cap);                                 \
     }                                                                          \
     type Vec_get_##type(Vec_##type vec, int i)                                 \
     {                                                                          \
@@ -29,10 +47,11 @@ void free_vec(void* v) { free(((struct Vec*)v)->data); }
     }                                                                          \
     void Vec_grow_##type(Vec_##type* vec)                                      \
     {                                                                          \
-        type* new_data = (type*)malloc(                                        \
-            GROWTH_FACTOR * (unsigned long)vec->cap * sizeof(type));           \
+        size_t const sz =                                                      \
+            GROWTH_FACTOR * (unsigned long)vec->cap * sizeof(type);            \
+        type* new_data = (type*)vec_alloc(vec->arena, sz);                     \
         memcpy(new_data, vec->data, vec->sz * sizeof(type));                   \
-        free(vec->data);                                                       \
+        if (!vec->arena) { tracked_free(vec->data); }                          \
         vec->cap  = GROWTH_FACTOR * vec->cap;                                  \
         vec->data = new_data;                                                  \
     }                                                                          \
@@ -7,6 +7,8 @@
 
 #include <stdbool.h>
 
+#include "arena.h"
+
 /*!
  * \brief Macro for forward_declaring a vector
  *
@@ -18,6 +20,9 @@
  * vector functions will be possible, as soon as they've been added into the
  * _Generic declarations
  *
+ * A vector created with new_vec_type_in allocates its elements from an \ref
+ * Arena instead of the heap, and needs no \ref free_vec.
+ *
  * \param type The type that the vector will contain
  */
 #define FORWARD_DECLARE_VEC(type)                                              \
@@ -26,12 +31,14 @@
         int sz;                                                                \
         int cap;                                                               \
         type* data;                                                            \
+        struct Arena* arena;                                                   \
     } Vec_##type;                                                              \
     type Vec_get_##type(Vec_##type vec, int i);                                \
     void Vec_push_##type(Vec_##type* v, type e);                               \
     bool Vec_contains_##type(Vec_##type v, type e);                            \
     type Vec_back_##type(Vec_##type v);                                        \
     type vec_pop_##type(Vec_##type* v);                                        \
+    Vec_##type new_vec_##type##_in(struct Arena* arena, int cap);              \
     Vec_##type new_vec_##type(int cap)
 
 enum
@@ -68,7 +75,7 @@ typedef struct Coord
     int x;
 } coord;
 
-//! Free the resources associated with vector
+//! Free the resources associated with vector, unless they belong to an arena
 void free_vec(void* v);
 
 FORWARD_DECLARE_VEC(int);
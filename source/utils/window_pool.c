@@ -0,0 +1,312 @@
+/*!
+ * \file window_pool.c
+ * \brief Implementation file to \ref window_pool.h
+ *
+ * Every SCREEN has windows of its own, so the pool and the layers are kept
+ * per SCREEN, told apart by their stdscr.
+ *
+ * The pool holds the windows that have been released and not taken again.
+ * A window is taken by preference at the same size and position, then at the
+ * same size, and otherwise any window is resized and moved. Only when that
+ * fails, or the pool is empty, is a new window created.
+ *
+ * The layers are the windows and pads on screen, from the bottom up, with
+ * stdscr, which is kept blank, below all of them. Taking a layer away touches
+ * the lines it covered in every layer below, and copies them to the screen
+ * again in order, so that the terminal only redraws what was covered.
+ *
+ * Nothing here writes to the terminal itself: windows and pads are only copied
+ * to the virtual screen, which \ref commit_frame draws.
+ *
+ * When the terminal is resized, what it shows can't be trusted, so the whole
+ * screen is drawn again from the layers. Moving a layer only redraws the lines
+ * it left and the lines it moved to.
+ */
+
+#include <ncurses.h>
+#include <stdbool.h>
+
+#include "accounting.h"
+#include "io/logging.h"
+#include "window_pool.h"
+
+enum
+{
+    //! Most windows kept, more than are ever released in a row
+    WINDOW_POOL_SIZE = 8,
+    //! Most windows and pads on screen at once
+    LAYERS_MAX = 16
+};
+
+//! A window, or a part of a pad, on screen
+typedef struct Layer
+{
+    WINDOW* win;
+    bool is_pad;
+    //! Where a pad is shown, windows know where they are themselves
+    int y;
+    int x;
+    int height;
+    int width;
+} Layer;
+
+//! The windows of a SCREEN
+typedef struct Screen_windows
+{
+    //! The stdscr of the SCREEN
+    WINDOW* screen;
+    WINDOW* pool[WINDOW_POOL_SIZE];
+    int pool_len;
+    Layer layers[LAYERS_MAX];
+    int layers_len;
+} Screen_windows;
+
+//NOLINTBEGIN
+static Screen_windows* screens = NULL;
+static int screens_len         = 0;
+//NOLINTEND
+
+//! Returns the windows of the current SCREEN
+static Screen_windows* current_screen(void)
+{
+    for (int i = 0; i < screens_len; ++i) {
+        if (screens[i].screen == stdscr) { return &screens[i]; }
+    }
+
+    screens = (Screen_windows*)tracked_realloc(
+        sub_window, screens,
+        sizeof(Screen_windows) * (size_t)(screens_len + 1));
+    screens[screens_len] = (Screen_windows){.screen = stdscr};
+    return &screens[screens_len++];
+}
+
+//! How well win fits a request, higher is better
+static int fit(WINDOW* win, int height, int width, int y, int x)
+{
+    bool const same_size  = getmaxy(win) == height && getmaxx(win) == width;
+    bool const same_place = getbegy(win) == y && getbegx(win) == x;
+    return same_size ? 1 + same_place : 0;
+}
+
+//! Makes win height lines by width columns at (y, x), false if ncurses can't
+static bool place(WINDOW* win, int height, int width, int y, int x)
+{
+    if ((getmaxy(win) != height || getmaxx(win) != width) &&
+        wresize(win, height, width) == ERR) {
+        return false;
+    }
+    return (getbegy(win) == y && getbegx(win) == x) || mvwin(win, y, x) != ERR;
+}
+
+//! Returns a window from the pool of s, or a new one, see \ref take_window
+static WINDOW* take_from_pool(Screen_windows* s, int height, int width, int y,
+                              int x)
+{
+    int best = -1;
+    for (int i = 0; i < s->pool_len; ++i) {
+        if (best < 0 || fit(s->pool[i], height, width, y, x) >
+                            fit(s->pool[best], height, width, y, x)) {
+            best = i;
+        }
+    }
+
+    if (best >= 0) {
+        WINDOW* win   = s->pool[best];
+        s->pool[best] = s->pool[--s->pool_len];
+        if (place(win, height, width, y, x)) {
+            // Drawn in full on the next refresh, like a new window
+            touchwin(win);
+            return win;
+        }
+        delwin(win);
+    }
+
+    return newwin(height, width, y, x);
+}
+
+//! Blanks win and sets it up like a new window, without drawing anything
+static void blank(WINDOW* win)
+{
+    wbkgdset(win, ' ');
+    wattrset(win, A_NORMAL);
+    werase(win);
+    keypad(win, false);
+}
+
+//! Puts win, which has been blanked, in the pool of s if there is room for it
+static void keep_in_pool(Screen_windows* s, WINDOW* win)
+{
+    if (s->pool_len == WINDOW_POOL_SIZE) {
+        delwin(win);
+        return;
+    }
+    s->pool[s->pool_len++] = win;
+}
+
+static void push_layer(Screen_windows* s, Layer layer)
+{
+    if (s->layers_len == LAYERS_MAX) {
+        log_and_exit("More than %d layers on screen in %s\n", LAYERS_MAX,
+                     __func__);
+    }
+    s->layers[s->layers_len++] = layer;
+}
+
+//! Takes the layer of win out of s, returns false if win isn't one
+static bool remove_layer(Screen_windows* s, WINDOW* win, Layer* removed)
+{
+    for (int i = s->layers_len - 1; i >= 0; --i) {
+        if (s->layers[i].win != win) { continue; }
+
+        *removed = s->layers[i];
+        --s->layers_len;
+        for (int j = i; j < s->layers_len; ++j) {
+            s->layers[j] = s->layers[j + 1];
+        }
+        return true;
+    }
+    return false;
+}
+
+//! Copies the lines from top up to bottom of layer to the virtual screen
+static void stage_lines(Layer const* layer, int top, int bottom)
+{
+    int const y      = layer->is_pad ? layer->y : getbegy(layer->win);
+    int const height = layer->is_pad ? layer->height : getmaxy(layer->win);
+    if (top < y) { top = y; }
+    if (bottom > y + height) { bottom = y + height; }
+    if (top >= bottom) { return; }
+
+    touchline(layer->win, top - y, bottom - top);
+    if (layer->is_pad) {
+        pnoutrefresh(layer->win, 0, 0, layer->y, layer->x,
+                     layer->y + layer->height - 1,
+                     layer->x + layer->width - 1);
+    }
+    else {
+        wnoutrefresh(layer->win);
+    }
+}
+
+//! Stages the lines from top up to bottom from the layers of s
+static void repaint_lines(Screen_windows const* s, int top, int bottom)
+{
+    Layer const background = {.win = stdscr};
+    stage_lines(&background, top, bottom);
+    for (int i = 0; i < s->layers_len; ++i) {
+        stage_lines(&s->layers[i], top, bottom);
+    }
+}
+
+//! Repaints what layer covered, which has been taken out of s
+static void uncover(Screen_windows const* s, Layer const* layer)
+{
+    int const y      = layer->is_pad ? layer->y : getbegy(layer->win);
+    int const height = layer->is_pad ? layer->height : getmaxy(layer->win);
+    repaint_lines(s, y, y + height);
+}
+
+WINDOW* take_window(int height, int width, int y, int x)
+{
+    Screen_windows* s = current_screen();
+    WINDOW* win       = take_from_pool(s, height, width, y, x);
+    if (win) { push_layer(s, (Layer){.win = win}); }
+    return win;
+}
+
+void release_window(WINDOW* win)
+{
+    if (!win) { return; }
+
+    Screen_windows* s = current_screen();
+    Layer layer       = {0};
+    blank(win);
+    if (remove_layer(s, win, &layer)) { uncover(s, &layer); }
+    else {
+        wnoutrefresh(win);
+    }
+
+    keep_in_pool(s, win);
+}
+
+bool move_window(WINDOW* win, int height, int width, int y, int x)
+{
+    // What doesn't fit is cut off at the bottom and the right
+    if (y < 0) { y = 0; }
+    if (x < 0) { x = 0; }
+    int const from_y      = getbegy(win);
+    int const from_height = getmaxy(win);
+    if (from_y == y && getbegx(win) == x && from_height == height &&
+        getmaxx(win) == width) {
+        return false;
+    }
+    bool const moved = place(win, height, width, y, x);
+
+    // Even a window that couldn't be moved may have been resized
+    int const to_y      = getbegy(win);
+    int const to_bottom = to_y + getmaxy(win);
+    int const top       = from_y < to_y ? from_y : to_y;
+    int const bottom    = from_y + from_height > to_bottom
+                              ? from_y + from_height
+                              : to_bottom;
+    repaint_lines(current_screen(), top, bottom);
+    return moved;
+}
+
+void repaint_screen(void)
+{
+    clearok(curscr, true);
+    repaint_lines(current_screen(), 0, LINES);
+}
+
+/*!
+ * A pad already shown at the same place is left where it is in the layers, and
+ * isn't drawn again.
+ */
+void show_pad(WINDOW* pad, int y, int x, int height, int width)
+{
+    Screen_windows* s = current_screen();
+    Layer const layer = {pad, true, y, x, height, width};
+    for (int i = 0; i < s->layers_len; ++i) {
+        Layer const* l = &s->layers[i];
+        if (l->win == pad && l->y == y && l->x == x && l->height == height &&
+            l->width == width) {
+            return;
+        }
+    }
+
+    Layer old = {0};
+    if (remove_layer(s, pad, &old)) { uncover(s, &old); }
+
+    push_layer(s, layer);
+    // Only touched lines are copied, and the last copy untouched them all
+    touchwin(pad);
+    pnoutrefresh(pad, 0, 0, y, x, y + height - 1, x + width - 1);
+}
+
+void hide_pad(WINDOW* pad)
+{
+    Screen_windows* s = current_screen();
+    Layer layer       = {0};
+    if (remove_layer(s, pad, &layer)) { uncover(s, &layer); }
+}
+
+/*!
+ * The windows left are blanked and go back to the pool, without drawing
+ * anything, and pads are only forgotten.
+ */
+void forget_layers(void)
+{
+    Screen_windows* s = current_screen();
+    while (s->layers_len > 0) {
+        Layer const layer = s->layers[--s->layers_len];
+        if (layer.is_pad) { continue; }
+
+        blank(layer.win);
+        keep_in_pool(s, layer.win);
+    }
+}
+
+void stage_window(WINDOW* win) { wnoutrefresh(win); }
+
+void commit_frame(void) { doupdate(); }
@@ -0,0 +1,72 @@
+/*!
+ * \file window_pool.h
+ * \brief Windows that are kept for reuse instead of deleted, and layered on
+ * screen
+ *
+ * Menus, dialogues and puzzles show a window, wait for keys and take the
+ * window down again, often at the same size and position as the last one. A
+ * window released into the pool is handed out again by \ref take_window,
+ * moved and resized in place when needed, so that showing something only
+ * creates a window when the pool has none to spare.
+ *
+ * The windows taken, and the pads shown with \ref show_pad, are stacked in the
+ * order they were shown. Whatever a window or pad covered reappears when it is
+ * taken away, redrawn from the content of the ones below, so an overlay such
+ * as a dialogue can come and go over a scene without the scene knowing.
+ *
+ * Drawing is done a frame at a time. Windows are staged with \ref stage_window
+ * rather than refreshed, which only copies them to the virtual screen, and
+ * the terminal is updated once per frame by \ref commit_frame, which \ref
+ * read_key calls before waiting for a key. A frame drawing a banner, a menu and
+ * a dialogue thus reaches the terminal in one write, without the in-between
+ * states.
+ *
+ * When the terminal is resized the screen is drawn again by \ref
+ * repaint_screen, and the loop reading keys moves what it shows with \ref
+ * move_window to where it goes on the new screen.
+ */
+
+#pragma once
+
+#include <ncurses.h>
+
+/*!
+ * \brief Returns a blank window of height lines and width columns with its
+ * upper left corner at (y, x), or NULL where newwin would fail
+ *
+ * Settings of the window such as keypad are those of a new window. It is put on
+ * top of the other windows, and must be given back with \ref release_window,
+ * and not with delwin.
+ */
+WINDOW* take_window(int height, int width, int y, int x);
+
+//! Takes win off the screen and keeps it for \ref take_window
+void release_window(WINDOW* win);
+
+/*!
+ * \brief Moves win, from \ref take_window, to height lines by width columns at
+ * (y, x), where negative coordinates are taken as 0
+ *
+ * What win showed is kept, and what it covered before is uncovered.
+ *
+ * \returns false if win already was there, or couldn't be moved
+ */
+bool move_window(WINDOW* win, int height, int width, int y, int x);
+
+//! Draws the whole screen again from the windows and pads on it
+void repaint_screen(void);
+
+//! Shows the top left height by width corner of pad at (y, x), on top
+void show_pad(WINDOW* pad, int y, int x, int height, int width);
+
+//! Takes pad, shown by \ref show_pad, off the screen
+void hide_pad(WINDOW* pad);
+
+//! Forgets every window and pad on the current SCREEN, e.g. when it is reused
+void forget_layers(void);
+
+//! Copies win to the virtual screen, to be drawn by \ref commit_frame
+void stage_window(WINDOW* win);
+
+//! Draws everything staged since the last frame on the terminal at once
+void commit_frame(void);
@@ -0,0 +1,398 @@
+/*
+ * Drives a menu with far more choices than fit on screen through a terminal
+ * over pipes, checking where scrolling and filtering end up and that neither
+ * allocates, as well as menus read through changed key bindings and global
+ * keys, menus moved by resizing the terminal, the cells choices are drawn
+ * from, and packed art.
+ */
+
+#include <assert.h>
+#include <ncurses.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <term.h>
+#include <unistd.h>
+
+#include "accounting.h"
+#include "base.h"
+#include "io/keys.h"
+#include "io/logging.h"
+#include "io/utf8.h"
+#include "menu.h"
+#include "window_pool.h"
+
+//NOLINTBEGIN
+enum
+{
+    CHOICES = 10000,
+    LINES_  = 20
+};
+
+static Command commands[CHOICES + 1];
+static Option options[CHOICES + 1];
+static Option const* choices[CHOICES + 1];
+static char labels[CHOICES][16];
+
+static int key_fd              = -1;
+static char const* const* keys = NULL;
+static bool first_key          = true;
+
+//! The screen as it was when Esc was last pressed
+static WINDOW* before_escape = NULL;
+static int escapes           = 0;
+
+//! The menu shown by \ref choose, and the session it is shown to
+static Menu const* shown = NULL;
+static Context* playing  = NULL;
+//! Set when the screen has been resized since the last key
+static bool resized = false;
+
+static Command* select_choice(void* this, Context* ctx)
+{
+    (void)ctx;
+    return this;
+}
+
+//! Sends key, where names of keys (longer than a key) are looked up in
+//! terminfo
+static void send_key(char const* key)
+{
+    char const* seq = key[0] == 'k' && key[1] ? tigetstr(key) : key;
+    assert(seq && seq != (char*)-1);
+    if (write(key_fd, seq, strlen(seq)) != (ssize_t)strlen(seq)) {
+        perror("Failed to press a key");
+        exit(1);
+    }
+}
+
+//! Presses the next of keys
+static void press_key(void)
+{
+    if (!first_key) {
+        for (int i = 0; i < SUBSYSTEM_COUNT; ++i) {
+            assert(frame_alloc_counts((Subsystem)i).allocs == 0);
+        }
+    }
+    first_key = false;
+
+    if (before_escape) {
+        // The screen is restored once Esc has been handled
+        for (int y = 0; y < LINES; ++y) {
+            for (int x = 0; x < COLS; ++x) {
+                assert(mvwinch(curscr, y, x) == mvwinch(before_escape, y, x));
+            }
+        }
+        delwin(before_escape);
+        before_escape = NULL;
+    }
+
+    if (resized) {
+        // The box of the menu has been moved to where its layout says
+        Menu_layout const* l = shown->layout;
+        assert(l->screen.height == LINES && l->screen.width == COLS);
+        assert(mvwinch(curscr, l->y, l->x) == ACS_ULCORNER);
+        resized = false;
+    }
+
+    assert(*keys);
+    int height = 0;
+    int width  = 0;
+    if (sscanf(*keys, "resize %dx%d", &height, &width) == 2) {
+        // What ncurses does on SIGWINCH
+        assert(resize_term(height, width) == OK);
+        ungetch(KEY_RESIZE);
+        resized = true;
+        ++keys;
+        return;
+    }
+    send_key(*keys++);
+}
+
+static void set_up_terminal(void)
+{
+    setenv("LINES", "20", 1);
+    setenv("COLUMNS", "80", 1);
+
+    int in[2];
+    FILE* input  = pipe(in) == 0 ? fdopen(in[0], "r") : NULL;
+    FILE* output = fopen("/dev/null", "w");
+    SCREEN* s    = input && output ? newterm("xterm", output, input) : NULL;
+    if (!s) {
+        fprintf(stderr, "Failed to create a terminal\n");
+        exit(1);
+    }
+    key_fd = in[1];
+    noecho();
+    cbreak();
+    nonl();
+    keypad(stdscr, true);
+    meta(stdscr, true);
+    set_escdelay(10);
+    set_log_output(stderr);
+}
+
+static Menu make_big_menu(void)
+{
+    for (int i = 0; i <= CHOICES; ++i) {
+        if (i < CHOICES) {
+            snprintf(labels[i], sizeof labels[i], "Puzzle %d", i);
+        }
+        commands[i] = (Command){.execute = select_choice, .persistent = true};
+        options[i]  = (Option){.command = &commands[i],
+                               .label   = i < CHOICES ? labels[i] : u8"Ödla"};
+        choices[i]  = &options[i];
+    }
+
+    Menu m = {.choices        = choices,
+              .choices_height = CHOICES + 1,
+              .choices_width  = 10,
+              .banner         = {.art = NULL},
+              .start_x        = -1,
+              .start_y        = -1};
+    implementation_initialise_menu(&m);
+    assert(m.sorted_choices && m.layout);
+    return m;
+}
+
+//! Plays script on menu and returns the index of the choice selected
+static int choose(Menu const* menu, char const* const* script)
+{
+    keys        = script;
+    first_key   = true;
+    shown       = menu;
+    Context ctx = {0};
+    playing     = &ctx;
+    Command* c  = print_menu(&ctx, menu, 0);
+    assert(*keys == NULL && !ctx.in_global_key);
+    return (int)(c - commands);
+}
+
+void test_scrolling(Menu const* m)
+{
+    char const* const script[] = {"kend", "kpp",   "kcuu1", "khome", "knp",
+                                  "knp",  "kcud1", "\r",    NULL};
+    assert(choose(m, script) == 2 * (LINES_ - 2) + 1);
+
+    char const* const wrap[] = {"kcuu1", "\r", NULL};
+    assert(choose(m, wrap) == CHOICES);
+    assert(m->layout->view_height == LINES_ - 2);
+}
+
+//! Like \ref choose, but with all of script pressed before the menu is shown
+static int choose_queued(Menu const* menu, char const* const* script)
+{
+    for (char const* const* key = script; *key; ++key) { send_key(*key); }
+    char const* const none[] = {NULL};
+    return choose(menu, none);
+}
+
+void test_queued_keys(Menu const* m)
+{
+    char const* const moves[] = {"kcud1", "kcud1", "kcud1", "\r", NULL};
+    assert(choose_queued(m, moves) == 3);
+
+    char const* const pages[] = {"knp", "kcud1", "kcuu1", "kcuu1", "\r", NULL};
+    assert(choose_queued(m, pages) == LINES_ - 2 - 1);
+
+    char const* const wrap[] = {"kcuu1", "kcuu1", "\r", NULL};
+    assert(choose_queued(m, wrap) == CHOICES - 1);
+
+    // Typing after moving filters, and moving after that moves in the filter
+    char const* const typed[] = {"kcud1", "p", "u", "z", "z", "l", "e", " ",
+                                 "7", "kcud1", "\r", NULL};
+    assert(choose_queued(m, typed) == 70);
+
+    // Letters bound to moves are typed, even when queued behind a move
+    char const* const bound[] = {"kcud1", "s", "w", "kbs", "kbs", "kcud1",
+                                 "\r", NULL};
+    assert(choose_queued(m, bound) == 1);
+}
+
+//! Returns the character of cell, and its attributes through attr
+static wchar_t cell_char(cchar_t const* cell, attr_t* attr)
+{
+    wchar_t chars[CCHARW_MAX + 1];
+    short pair = 0;
+    assert(getcchar(cell, chars, attr, &pair, NULL) == OK);
+    return chars[0];
+}
+
+void test_choice_cells(Menu const* m)
+{
+    int const width = m->choices_width + 2;
+    attr_t attr     = A_NORMAL;
+
+    // The label is converted from UTF-8, and padded to the width of the menu
+    cchar_t const* plain = m->choice_lines[2 * CHOICES];
+    assert(cell_char(&plain[0], &attr) == L'Ö' && attr == A_NORMAL);
+    assert(cell_char(&plain[3], &attr) == L'a');
+    assert(cell_char(&plain[width - 1], &attr) == L' ' && attr == A_NORMAL);
+
+    // The highlighted line stands out, after the selection string
+    cchar_t const* highlighted = m->choice_lines[2 * CHOICES + 1];
+    assert(cell_char(&highlighted[0], &attr) == L'◇' && attr == A_STANDOUT);
+    assert(cell_char(&highlighted[2], &attr) == L'Ö');
+    assert(cell_char(&highlighted[width - 1], &attr) == L' ' &&
+           attr == A_STANDOUT);
+}
+
+void test_packed_banner(void)
+{
+    // "⠀⠀⠀⠀⠀⣿" and "ab", with the blank braille packed as a run. Banners are
+    // told apart by their art, which is static like generated art
+    static wchar_t const glyphs[]      = {L'⠀', L'⣿', L'a', L'b'};
+    static unsigned char const codes[] = {ART_RUN, 5, 0, 1, ART_LINE_END,
+                                          2,       3, ART_LINE_END};
+    static Packed_art const art        = {glyphs, codes};
+    Banner const b = {.packed = &art, .dim = {2, 6}};
+
+    WINDOW* pad = newpad(2, 6);
+    paint_banner(pad, b, 0, 0);
+    wchar_t const* const want[] = {L"⠀⠀⠀⠀⠀⣿", L"ab    "};
+    for (int y = 0; y < 2; ++y) {
+        for (int x = 0; x < 6; ++x) {
+            cchar_t cell;
+            attr_t attr = A_NORMAL;
+            assert(mvwin_wch(pad, y, x, &cell) == OK);
+            assert(cell_char(&cell, &attr) == want[y][x]);
+        }
+    }
+    delwin(pad);
+}
+
+void test_resize(Menu const* m)
+{
+    // Pages are as long as the screen allows
+    char const* const grow[] = {"resize 30x100", "knp", "\r", NULL};
+    assert(choose(m, grow) == 30 - 2);
+    assert(m->layout->x == (100 - (m->choices_width + 2)) / 2);
+
+    // The filter survives the menu moving
+    char const* const shrink[] = {"p",   "u",   "z",  "z",
+                                  "l",   "e",   " ",  "resize 20x80",
+                                  "kcud1", "\r", NULL};
+    assert(choose(m, shrink) == 1);
+    assert(m->layout->view_height == LINES_ - 2);
+    assert(LINES == LINES_ && COLS == 80);
+}
+
+/*!
+ * Covers the whole screen, which is restored once the cover is released, and
+ * reads Esc again meanwhile, as the session handling it and as another one
+ */
+static bool cover_screen(Input_event const* event)
+{
+    assert(event->action == act_escape && event->read_ns > 0);
+    // The session isn't put away at its menu while it handles a key
+    assert(playing->in_global_key && !playing->checkpoint);
+    if (++escapes > 1) { return true; }
+
+    before_escape = newpad(LINES, COLS);
+    copywin(curscr, before_escape, 0, 0, 0, 0, LINES - 1, COLS - 1, false);
+
+    WINDOW* cover = take_window(LINES, COLS, 0, 0);
+    wbkgd(cover, '#');
+    wrefresh(cover);
+
+    // The session handling Esc reads it like any other key
+    send_key("\x1b");
+    send_key("x");
+    assert(read_input(playing, cover).action == act_escape);
+    assert(read_input(playing, cover).key == 'x' && escapes == 1);
+
+    // Another session has its own Esc handled all the same
+    Context other = {0};
+    send_key("\x1b");
+    send_key("x");
+    assert(read_input(&other, cover).key == 'x' && escapes == 2);
+    assert(!other.in_global_key);
+
+    release_window(cover);
+    return true;
+}
+
+void test_global_key(Menu const* m)
+{
+    set_global_key(act_escape, cover_screen);
+    char const* const script[] = {"\x1b", "kcud1", "\r", NULL};
+    assert(choose(m, script) == 1);
+    assert(escapes == 2 && !before_escape);
+    set_global_key(act_escape, NULL);
+}
+
+void test_key_bindings(void)
+{
+    char path[] = "/tmp/menu_test_keysXXXXXX";
+    int fd      = mkstemp(path);
+    FILE* f     = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (!f) {
+        perror("Failed to write key bindings");
+        exit(1);
+    }
+    fputs("# vi keys\n\ndown j\nup k\nselect KEY_RIGHT\njump x\n", f);
+    fclose(f);
+
+    // The unknown action is skipped, the rest bound
+    assert(!load_key_bindings(path));
+    remove(path);
+    assert(key_action('j') == act_down && key_action(KEY_RIGHT) == act_select);
+
+    Menu small = {.choices        = choices,
+                  .choices_height = 5,
+                  .choices_width  = 10,
+                  .banner         = {.art = NULL},
+                  .start_x        = -1,
+                  .start_y        = -1};
+    implementation_initialise_menu(&small);
+    char const* const script[] = {"j", "j", "j", "k", "kcuf1", NULL};
+    assert(choose(&small, script) == 2);
+    implementation_release_menu(&small);
+
+    reset_key_bindings();
+    assert(key_action('j') == act_none && key_action(KEY_RIGHT) == act_right);
+}
+
+void test_filtering(Menu const* m)
+{
+    char const* const exact[] = {"P", "U", "Z", "Z", "L", "E", " ",
+                                 "9", "9", "\r", NULL};
+    assert(choose(m, exact) == 99);
+
+    char const* const next[] = {"p", "u", "z", "z", "l", "e", " ", "9", "9",
+                                "kcud1", "\r", NULL};
+    assert(choose(m, next) == 990);
+
+    // Nothing can be selected while nothing matches
+    char const* const erase[] = {"p", "x", "\r", "kbs", "u", "z", "z", "l",
+                                 "e", " ", "4", "2", "\r", NULL};
+    assert(choose(m, erase) == 42);
+
+    char const* const utf8[] = {"\xC3", "\x96", "\r", NULL};
+    assert(choose(m, utf8) == CHOICES);
+
+    char const* const utf8_erase[] = {"\xC3", "\x96", "kbs", "p", "\r", NULL};
+    assert(choose(m, utf8_erase) == 0);
+}
+
+void test(void)
+{
+    set_up_terminal();
+    set_input_wait(press_key);
+    Menu m = make_big_menu();
+
+    test_choice_cells(&m);
+    test_packed_banner();
+    test_scrolling(&m);
+    test_queued_keys(&m);
+    test_filtering(&m);
+    test_resize(&m);
+    test_global_key(&m);
+    test_key_bindings();
+
+    implementation_release_menu(&m);
+}
+
+//NOLINTEND
+
+int main(void) { test(); }
@@ -0,0 +1,181 @@
+/*
+ * Plays scripted sessions on a terminal over pipes and checks the allocation
+ * counts: once the script loops, moving through a menu must not allocate, and
+ * neither a loop nor a whole session may leave memory behind.
+ */
+
+#include <assert.h>
+#include <ncurses.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <term.h>
+#include <unistd.h>
+
+#include "accounting.h"
+#include "base.h"
+#include "io/utf8.h"
+#include "menu.h"
+#include "menu_constants.h"
+#include "start.h"
+#include "state.h"
+
+//NOLINTBEGIN
+typedef struct Step
+{
+    struct Menu const* const* menu;
+    int choice;
+} Step;
+
+//! Options -> Katte mode -> Back, repeated by the script
+static Step const loop[] = {
+    {&start_menu,   1},
+    {&options_menu, 1},
+    {&options_menu, 3},
+};
+enum
+{
+    LOOP_LEN   = sizeof loop / sizeof loop[0],
+    ITERATIONS = 5,
+    START_EXIT = 2
+};
+
+static Context* ctx                 = NULL;
+static int key_fd                   = -1;
+static int step                     = 0;
+static int iteration                = 0;
+static bool moved                   = false;
+static long long live_at_loop_start = -1;
+
+static long long total_live_bytes(void)
+{
+    long long res = 0;
+    for (int i = 0; i < SUBSYSTEM_COUNT; ++i) {
+        res += alloc_counts((Subsystem)i).live_bytes;
+    }
+    return res;
+}
+
+static void send_key(char const* key)
+{
+    size_t const len = strlen(key);
+    if (write(key_fd, key, len) != (ssize_t)len) {
+        perror("Failed to press a key");
+        exit(1);
+    }
+}
+
+//! Checks that the frame that just ended, moving the highlight, allocated
+//! nothing once the script has gone around its loop
+static void check_move_frame(void)
+{
+    if (!moved || iteration == 0) { return; }
+    for (int i = 0; i < SUBSYSTEM_COUNT; ++i) {
+        Alloc_counts const c = frame_alloc_counts((Subsystem)i);
+        if (c.allocs != 0) {
+            fprintf(stderr, "Moving through a menu allocated %ld times in %s\n",
+                    c.allocs, subsystem_name((Subsystem)i));
+            exit(1);
+        }
+    }
+}
+
+//! Checks that every lap of the loop ends with the memory it started with
+static void check_loop_start(void)
+{
+    long long const live = total_live_bytes();
+    if (iteration > 1 && live != live_at_loop_start) {
+        fprintf(stderr, "Iteration %d of the loop leaked %lld bytes\n",
+                iteration, live - live_at_loop_start);
+        exit(1);
+    }
+    live_at_loop_start = live;
+}
+
+//! Presses the key the script calls for next, see \ref set_input_wait
+static void press_key(void)
+{
+    check_move_frame();
+    moved = false;
+
+    Menu_command const* mc = (Menu_command const*)ctx->checkpoint;
+    if (!mc) {
+        // Dialogues, which take any key
+        send_key("w");
+        return;
+    }
+
+    Step const target = iteration < ITERATIONS
+                            ? loop[step]
+                            : (Step){&start_menu, START_EXIT};
+    assert(mc->menu == *target.menu);
+    if (step == 0 && mc->highlight == target.choice) { check_loop_start(); }
+
+    if (mc->highlight != target.choice) {
+        send_key(tigetstr("kcud1"));
+        moved = true;
+        return;
+    }
+    send_key("\r");
+    if (++step == LOOP_LEN) {
+        step = 0;
+        ++iteration;
+    }
+}
+
+static void set_up_terminal(void)
+{
+    // Large enough for every menu and dialogue
+    setenv("LINES", "60", 1);
+    setenv("COLUMNS", "200", 1);
+
+    int in[2];
+    FILE* input  = pipe(in) == 0 ? fdopen(in[0], "r") : NULL;
+    FILE* output = fopen("/dev/null", "w");
+    SCREEN* s    = input && output ? newterm("xterm", output, input) : NULL;
+    if (!s) {
+        fprintf(stderr, "Failed to create a terminal\n");
+        exit(1);
+    }
+    key_fd = in[1];
+    noecho();
+    cbreak();
+    nonl();
+    keypad(stdscr, true);
+}
+
+static void play_session(void)
+{
+    step      = 0;
+    iteration = 0;
+    ctx       = new_game_context();
+    run_game(ctx);
+    free_game_context(ctx);
+    assert(iteration == ITERATIONS);
+}
+
+void test_session(void)
+{
+    set_up_terminal();
+    initialise_menus();
+    set_input_wait(press_key);
+
+    long long const before = alloc_counts(sub_application).live_bytes +
+                             alloc_counts(sub_base).live_bytes;
+    play_session();
+    long long const after_first = total_live_bytes();
+    assert(alloc_counts(sub_application).live_bytes +
+               alloc_counts(sub_base).live_bytes ==
+           before);
+
+    // Caches filled by the first session stay, but nothing more may
+    play_session();
+    assert(total_live_bytes() == after_first);
+}
+
+void test(void) { test_session(); }
+
+//NOLINTEND
+
+int main(void) { test(); }
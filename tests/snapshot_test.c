@@ -0,0 +1,167 @@
+/*
+ * Writes a session waiting at a sudoku to a snapshot and reads it back,
+ * checking that the progress, the settings and every kind of command on the
+ * stack survive, that nothing leaks, and that broken snapshots are rejected.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+
+#include "accounting.h"
+#include "base.h"
+#include "games/sudoku.h"
+#include "menu.h"
+#include "menu_constants.h"
+#include "snapshot.h"
+#include "start.h"
+#include "state.h"
+
+//NOLINTBEGIN
+enum
+{
+    HIGHLIGHT = 2,
+    CURSOR_Y  = 4,
+    CURSOR_X  = 7
+};
+
+//! A puzzle, which snapshots refer to by address like persistent commands
+static Sudoku_command const puzzle = {
+    .command = {.execute = paint_sudoku, .persistent = true}};
+
+static long long total_live_bytes(void)
+{
+    long long res = 0;
+    for (int i = 0; i < SUBSYSTEM_COUNT; ++i) {
+        res += alloc_counts((Subsystem)i).live_bytes;
+    }
+    return res;
+}
+
+//! Creates a session waiting at puzzle, with every kind of command on its
+//! stack
+static Context* make_session(void)
+{
+    Context* ctx = new_game_context();
+    player_visited_glade_set(ctx);
+    player_has_key_set(ctx);
+    set_katte_mode(ctx, true);
+
+    push_command(ctx, (Command*)&show_glade);
+    push_command(ctx, (Command*)&show_cabin);
+    push_command(ctx, new_menu_command(start_menu, HIGHLIGHT));
+    push_command(ctx, new_command(show_opening, false));
+
+    Sudoku_progress* p =
+        (Sudoku_progress*)tracked_calloc(sub_application, 1, sizeof *p);
+    p->command = (Command){.execute = resume_sudoku, .persistent = false};
+    p->puzzle  = &puzzle;
+    for (int i = 0; i < 81; ++i) { p->board[i / 9][i % 9] = i % 10; }
+    p->y            = CURSOR_Y;
+    p->x            = CURSOR_X;
+    ctx->checkpoint = (Command*)p;
+    return ctx;
+}
+
+static void free_session(Context* ctx)
+{
+    if (ctx->checkpoint && !ctx->checkpoint->persistent) {
+        tracked_free(ctx->checkpoint);
+    }
+    free_game_context(ctx);
+}
+
+//! Returns a file holding the first length bytes of a snapshot of ctx, or all
+//! of it if length is negative
+static FILE* snapshot_of(Context const* ctx, long length)
+{
+    FILE* f = tmpfile();
+    assert(f && write_snapshot(f, ctx));
+    if (length >= 0) {
+        FILE* cut = tmpfile();
+        assert(cut);
+        rewind(f);
+        for (long i = 0; i < length; ++i) { (void)fputc(fgetc(f), cut); }
+        (void)fclose(f);
+        f = cut;
+    }
+    rewind(f);
+    return f;
+}
+
+void test_round_trip(void)
+{
+    long long const before = total_live_bytes();
+    Context* ctx           = make_session();
+    FILE* f                = snapshot_of(ctx, -1);
+    free_session(ctx);
+
+    Context* restored = read_snapshot(f);
+    (void)fclose(f);
+    assert(restored);
+    assert(player_visited_glade_val(restored) &&
+           player_has_key_val(restored) && !player_visited_well_val(restored));
+    assert(is_katte_mode(restored));
+
+    // Persistent commands come back as themselves, the others as copies
+    assert(command_stack_size(restored) == 4);
+    assert(command_stack_peek(restored, 3) == &show_glade);
+    assert(command_stack_peek(restored, 2) == &show_cabin.command);
+    Menu_command const* mc =
+        (Menu_command const*)command_stack_peek(restored, 1);
+    assert(mc->command.execute == show_menu && !mc->command.persistent);
+    assert(mc->menu == start_menu && mc->highlight == HIGHLIGHT);
+    Command const* c = command_stack_peek(restored, 0);
+    assert(c->execute == show_opening && !c->persistent);
+
+    Sudoku_progress const* p = (Sudoku_progress const*)restored->checkpoint;
+    assert(p->command.execute == resume_sudoku && !p->command.persistent);
+    assert(p->puzzle == &puzzle);
+    for (int i = 0; i < 81; ++i) { assert(p->board[i / 9][i % 9] == i % 10); }
+    assert(p->y == CURSOR_Y && p->x == CURSOR_X);
+
+    free_session(restored);
+    assert(total_live_bytes() == before);
+}
+
+void test_broken_snapshots(void)
+{
+    long long const before = total_live_bytes();
+    Context* ctx           = make_session();
+
+    // Only a session waiting at a checkpoint can be written
+    Command* checkpoint = ctx->checkpoint;
+    ctx->checkpoint     = NULL;
+    FILE* f             = tmpfile();
+    assert(f && !write_snapshot(f, ctx));
+    (void)fclose(f);
+    ctx->checkpoint = checkpoint;
+
+    // Not a snapshot
+    f = snapshot_of(ctx, -1);
+    (void)fputc('X', f);
+    rewind(f);
+    assert(!read_snapshot(f));
+    (void)fseek(f, 0, SEEK_END);
+    long const length = ftell(f);
+    (void)fclose(f);
+
+    // Cut short anywhere, in the header, the stack or the checkpoint
+    for (long cut = 0; cut < length; ++cut) {
+        f = snapshot_of(ctx, cut);
+        assert(!read_snapshot(f));
+        (void)fclose(f);
+    }
+
+    free_session(ctx);
+    assert(total_live_bytes() == before);
+}
+
+void test(void)
+{
+    test_round_trip();
+    test_broken_snapshots();
+}
+
+//NOLINTEND
+
+int main(void) { test(); }
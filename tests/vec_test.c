@@ -1,6 +1,8 @@
 #include "vec.h"
 #include <assert.h>
 
+#include "arena.h"
+
 //NOLINTBEGIN
 void test_new_free(void)
 {
@@ -60,11 +62,35 @@ void test_pop(void)
     assert(v.sz == 4);
 }
 
+void test_arena(void)
+{
+    Arena arena = {0};
+    Vec_int v   = new_vec_int_in(&arena, 4);
+    for (int i = 0; i < 1000; ++i) { VEC_PUSH(&v, i); }
+    for (int i = 0; i < 1000; ++i) { assert(v.data[i] == i); }
+    // No-op for arena backed vectors
+    free_vec(&v);
+
+    // Once reset, an arena that had to grow fits the same frame in one block
+    arena_reset(&arena);
+    struct Arena_block* block = arena.blocks;
+    void* first               = arena_alloc(&arena, 1);
+    v                         = new_vec_int_in(&arena, 4);
+    for (int i = 0; i < 1000; ++i) { VEC_PUSH(&v, i); }
+    assert(arena.blocks == block);
+
+    arena_reset(&arena);
+    assert(arena.blocks == block);
+    assert(arena_alloc(&arena, 1) == first);
+    free_arena(&arena);
+}
+
 void test(void)
 {
     test_new_free();
     test_push();
     test_pop();
+    test_arena();
 }
 
 //NOLINTEND
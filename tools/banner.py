@@ -1,26 +1,143 @@
 #!/usr/bin/env python3
-import sys
+"""
+Turns art into C
+
+    banner.py art.txt
+        Prints the lines of art.txt as C string literals, e.g. to paste into
+        code.
+
+    banner.py -c art.c -H art.h art.txt...
+        Packs the art of every file into art.c, as a Packed_art named after
+        the file (well.txt becomes well_art), and declares it in art.h along
+        with a Banner initialiser, e.g. WELL_BANNER(). The initialiser holds
+        the height and width of the art, so that the game measures nothing at
+        runtime.
+
+The width is counted in unicode code points, like utf8_strlen does.
+
+Packed art is a list of the glyphs the art is drawn with, and a code for every
+glyph of every line, its index in the list. A run of at least MIN_RUN of the
+same glyph is instead RUN followed by its length and the code of the glyph,
+and every line is ended by LINE_END, see Packed_art in menu.h.
+"""
+import argparse
 import os
+import sys
+import textwrap
+
+# The codes that aren't glyphs, as in enum Art_code of menu.h
+LINE_END = 254
+RUN = 255
+# Shorter runs take no more codes as single glyphs
+MIN_RUN = 4
+MAX_RUN = 255
+
+
+def escape(line):
+    line = line.replace("\\", "\\\\")
+    return line.replace('"', '\\"')
+
+
+def read_art(path):
+    with open(path, encoding="utf-8") as f:
+        return [line.rstrip("\n") for line in f]
+
+
+def art_name(path):
+    name = os.path.splitext(os.path.basename(path))[0]
+    if not name.isidentifier():
+        sys.exit(f"Error: '{path}' doesn't name a C identifier")
+    return name
+
+
+def pack(path, lines):
+    """Returns the glyphs of the art and its codes"""
+    glyphs = list(dict.fromkeys("".join(lines)))
+    if not glyphs:
+        sys.exit(f"Error: '{path}' has no art")
+    if len(glyphs) > LINE_END:
+        sys.exit(f"Error: '{path}' has more than {LINE_END} distinct glyphs")
+    index = {glyph: i for i, glyph in enumerate(glyphs)}
+
+    codes = []
+    for line in lines:
+        i = 0
+        while i < len(line):
+            end = i + 1
+            while (end < len(line) and line[end] == line[i]
+                   and end - i < MAX_RUN):
+                end += 1
+            if end - i >= MIN_RUN:
+                codes += [RUN, end - i, index[line[i]]]
+            else:
+                codes += [index[line[i]]] * (end - i)
+            i = end
+        codes.append(LINE_END)
+    return glyphs, codes
+
+
+def write_array(out, declaration, values):
+    print(f"{declaration}[{len(values)}] = {{", file=out)
+    for line in textwrap.wrap(", ".join(values) + ",", 76):
+        print(f"    {line}", file=out)
+    print("};", file=out)
+
+
+def write_source(out, header, arts):
+    print("/* Generated by tools/banner.py, edit the art instead */\n", file=out)
+    print(f'#include "{os.path.basename(header)}"', file=out)
+    for name, (glyphs, codes) in arts:
+        print(file=out)
+        write_array(out, f"static wchar_t const {name}_glyphs",
+                    [f"{ord(glyph):#x}" for glyph in glyphs])
+        write_array(out, f"static unsigned char const {name}_codes",
+                    [str(code) for code in codes])
+        print(f"Packed_art const {name}_art = {{{name}_glyphs, {name}_codes}};",
+              file=out)
+
 
-argv = sys.argv
+def write_header(out, arts, sources):
+    guard = "ART_H"
+    print("/* Generated by tools/banner.py, edit the art instead */\n", file=out)
+    print(f"#ifndef {guard}\n#define {guard}\n", file=out)
+    print('#include "menu.h"', file=out)
+    for (name, lines, (glyphs, codes)), source in zip(arts, sources):
+        height = len(lines)
+        width = max(len(line) for line in lines)
+        utf8_bytes = sum(len(line.encode()) for line in lines)
+        print(f"\n//! {os.path.basename(source)}, {height} lines of {width} "
+              f"code points\n//! Packed into {len(codes)} codes from "
+              f"{utf8_bytes} bytes of UTF-8", file=out)
+        print(f"extern Packed_art const {name}_art;", file=out)
+        print(f"#define {name.upper()}_BANNER() {{.packed = &{name}_art, "
+              f".dim = {{{height}, {width}}}}}", file=out)
+    print("\n#endif", file=out)
 
-name = os.path.basename(argv[0])
 
-if len(argv) not in [2, 3]:
-    print("Error: Invalid command")
-    print(f"Usage: {name} target [output]")
-    exit(1)
+def main():
+    parser = argparse.ArgumentParser(description="Turns art into C")
+    parser.add_argument("-c", dest="source", help="C file to write")
+    parser.add_argument("-H", dest="header", help="header to write")
+    parser.add_argument("art", nargs="+", help="text files of art")
+    args = parser.parse_args()
 
+    if not args.source and not args.header:
+        for line in read_art(args.art[0]):
+            print(f'"{escape(line)}",')
+        return
+    if not args.source or not args.header:
+        parser.error("-c and -H go together")
 
-# os.path.exists()
-with open(argv[1]) as f:
-    lines = f.readlines()
-    for i, line in enumerate(lines):
-        line = line.strip("\n")
-        line = line.replace("\\", "\\\\")
-        line = line.replace('"', '\\"')
-        lines[i] = f'"{line}",'
+    arts = []
+    for path in args.art:
+        lines = read_art(path)
+        arts.append((art_name(path), lines, pack(path, lines)))
+    with open(args.source, "w", encoding="utf-8") as out:
+        write_source(out, args.header,
+                     [(name, packed) for name, _, packed in arts])
+    with open(args.header, "w", encoding="utf-8") as out:
+        write_header(out, arts, args.art)
 
 
-for line in lines:
-    print(line)
+if __name__ == "__main__":
+    main()
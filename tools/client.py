@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+"""Connects this terminal to a game server started with `serve`.
+
+Usage: client.py [-w session] <port|socket path>
+
+With -w the terminal watches a session on the watch address of a server
+started with `serve -w`, instead of playing. A session of "" watches the
+newest one. Press q or Ctrl-C to stop watching.
+"""
+import os
+import select
+import socket
+import sys
+import termios
+import tty
+
+argv = sys.argv
+name = os.path.basename(argv[0])
+
+watch = None
+if len(argv) == 4 and argv[1] == "-w":
+    watch = argv[2]
+    argv = argv[2:]
+
+if len(argv) != 2:
+    print("Error: Invalid command")
+    print(f"Usage: {name} [-w session] <port|socket path>")
+    exit(1)
+
+if argv[1].isdigit():
+    sock = socket.create_connection(("127.0.0.1", int(argv[1])))
+else:
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.connect(argv[1])
+if watch is not None:
+    sock.sendall(watch.encode() + b"\n")
+
+stdin = sys.stdin.fileno()
+stdout = sys.stdout.fileno()
+saved = termios.tcgetattr(stdin)
+tty.setraw(stdin)
+try:
+    while True:
+        readable, _, _ = select.select([sock, stdin], [], [])
+        if sock in readable:
+            data = sock.recv(4096)
+            if not data:
+                break
+            os.write(stdout, data)
+        if stdin in readable:
+            keys = os.read(stdin, 4096)
+            if watch is None:
+                sock.sendall(keys)
+            elif b"q" in keys or b"\x03" in keys:
+                break
+finally:
+    termios.tcsetattr(stdin, termios.TCSADRAIN, saved)